@@ -65,6 +65,14 @@ public:
 
     std::vector<int16_t> UniqueUnitsTechs = { -1, -1, -1, -1 }; // Unknown in >=SWGB (cnt=4)
 
+protected:
+    //----------------------------------------------------------------------------
+    /// Serializes everything up to and including the unit pointers.
+    ///
+    /// @return number of units
+    //
+    uint16_t serializeHeader(void);
+
 private:
     void serializeObject(void) override;
 };
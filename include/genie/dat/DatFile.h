@@ -23,10 +23,18 @@
 
 #include <string>
 #include <iostream>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 
 #include "genie/Types.h"
 #include "genie/file/IFile.h"
 #include "genie/file/Compressor.h"
+#include "genie/util/ThreadPool.h"
 #include "TerrainRestriction.h"
 #include "PlayerColour.h"
 #include "Sound.h"
@@ -47,6 +55,90 @@ namespace genie {
 class DatFile : public IFile
 {
 public:
+    /// Parts of the file that can be loaded on their own
+    enum Section {
+        SECTION_TERRAIN_RESTRICTIONS = 0,
+        SECTION_PLAYER_COLOURS,
+        SECTION_SOUNDS,
+        SECTION_GRAPHICS,
+        SECTION_TERRAIN_BLOCK,
+        SECTION_RANDOM_MAPS,
+        SECTION_EFFECTS,
+        SECTION_UNIT_LINES,
+        SECTION_UNIT_HEADERS,
+        SECTION_CIVS,
+        SECTION_TECHS,
+        SECTION_TECH_TREE,
+        SECTION_COUNT
+    };
+
+    //----------------------------------------------------------------------------
+    /// Receives objects while a file is read with stream(). The objects are
+    /// reused for the following ones, and only valid during the call.
+    //
+    class Visitor
+    {
+    public:
+        virtual ~Visitor() = default;
+
+        virtual void visitEffect(size_t /*index*/, const Effect & /*effect*/) {}
+
+        //--------------------------------------------------------------------------
+        /// Called for each civilization before its units, which aren't read
+        /// into civ.Units.
+        //
+        virtual void visitCiv(size_t /*index*/, const Civ & /*civ*/) {}
+
+        //--------------------------------------------------------------------------
+        /// Called for each unit of a civilization, except the missing ones.
+        ///
+        /// @param index index of the unit in the civilization
+        //
+        virtual void visitUnit(size_t /*civIndex*/, size_t /*index*/, const Unit & /*unit*/) {}
+
+        virtual void visitTech(size_t /*index*/, const Tech & /*tech*/) {}
+    };
+
+    /// What the last load or save spent on a section
+    struct SectionStats {
+        /// Wall time the calling thread spent on the section, including
+        /// inflating or deflating its data if that is done while parsing
+        double seconds = 0;
+
+        /// Time spent reading the objects that were deferred to the thread
+        /// pool or until they are accessed, added up over all threads.
+        /// Lazily loaded sections add to it whenever they are read.
+        double deferredSeconds = 0;
+
+        /// Size of the section in the decompressed data
+        uint64_t bytes = 0;
+
+        /// Number of objects, without missing graphics and without the units
+        /// of the civilizations
+        size_t objects = 0;
+
+        /// Heap allocations of the calling thread and of the deferred reads.
+        /// Empty unless the library counts them, see isCountingAllocations().
+        std::optional<uint64_t> allocations;
+
+        /// Copied from the data of the last load or save when saving
+        /// incrementally. Its objects aren't counted then.
+        bool cached = false;
+    };
+
+    /// What the last load or save spent on the file. The stats are always
+    /// collected, which costs a few clock readings per section.
+    struct Stats {
+        /// Wall time of the whole load or save, without opening the file
+        double seconds = 0;
+
+        /// Size of the decompressed data
+        uint64_t bytes = 0;
+
+        /// Sections that aren't in the game version stay empty.
+        std::array<SectionStats, SECTION_COUNT> sections;
+    };
+
     //----------------------------------------------------------------------------
     /// Standard constructor
     //
@@ -62,8 +154,12 @@ public:
 
     //----------------------------------------------------------------------------
     /// Uncompress dat file.
+    ///
+    /// @exception std::ios_base::failure thrown if inFile can't be read or
+    ///                                   inflated, or outFile can't be written
     //
-    void extractRaw(const char *inFile, const char *outFile);
+    void extractRaw(const char *inFile, const char *outFile,
+                    const DecompressOptions &options = DecompressOptions());
 
     //----------------------------------------------------------------------------
     /// Debug information will be printed to stdout if activated.
@@ -72,6 +168,229 @@ public:
     //
     void setVerboseMode(bool verbose);
 
+    //----------------------------------------------------------------------------
+    /// Sets the number of threads used for loading and saving, including the
+    /// calling one. With more than one, the file is decompressed into memory
+    /// first, and graphics, civilizations and techs are read by a thread pool
+    /// while the calling thread reads the rest of the file and skips over
+    /// them. The loaded data is the same as when loading with one thread.
+    /// When saving, the data is compressed in chunks in parallel, see
+    /// Compressor::setThreadPool().
+    ///
+    /// @param threadCount number of threads, 0 uses one per hardware thread
+    //
+    void setThreadCount(size_t threadCount);
+
+    //----------------------------------------------------------------------------
+    /// Number of threads used for loading and saving
+    //
+    size_t getThreadCount(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Sets the zlib compression level used for saving, from 0 (stored) to 9
+    /// (smallest). -1, the default, is zlib's default level 6.
+    //
+    void setCompressionLevel(int level);
+
+    //----------------------------------------------------------------------------
+    int getCompressionLevel(void) const;
+
+    //----------------------------------------------------------------------------
+    /// If enabled (the default), the file is inflated into memory at once
+    /// and parsed from there. Otherwise it is inflated while it is parsed,
+    /// which needs less memory but is slower. Lazy and parallel loading
+    /// always inflate into memory, streaming never does.
+    //
+    void setDecompressToMemory(bool inMemory);
+
+    //----------------------------------------------------------------------------
+    bool isDecompressingToMemory(void) const;
+
+    //----------------------------------------------------------------------------
+    /// If enabled, load() keeps the decompressed data and only locates the
+    /// objects of each section. A section is read the first time it is
+    /// accessed through its getter or loadSection(), civilizations one by one
+    /// through getCiv(). Saving loads everything first.
+    ///
+    /// Until a section is read, its public members only hold default
+    /// objects, so they must not be used directly before loadAllSections()
+    /// or the getter. Resizing or reassigning their vectors before then
+    /// makes the read throw std::logic_error.
+    //
+    void setLazyLoading(bool lazy);
+    bool isLazyLoading(void) const;
+
+    //----------------------------------------------------------------------------
+    /// If enabled, the decompressed data of the last load or save is kept,
+    /// and saving only serializes the sections and civilizations invalidated
+    /// since then. The others are copied from the kept data, only the
+    /// compression runs over everything. Loading only keeps the data if it
+    /// is decompressed into memory.
+    ///
+    /// Changes to the objects aren't detected, invalidateSection() or
+    /// invalidateCiv() need to be called after modifying them, otherwise the
+    /// old data is saved. Fields following the objects of a section belong to it, like
+    /// SUnknown7 to SECTION_CIVS and the history totals to SECTION_TECHS.
+    /// The file version and the SWGB header are always written.
+    //
+    void setIncrementalSaving(bool incremental);
+    bool isIncrementalSaving(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Makes the next incremental save serialize the section again.
+    /// Invalidating SECTION_CIVS includes all civilizations, which is needed
+    /// after adding or removing some.
+    //
+    void invalidateSection(Section section);
+
+    //----------------------------------------------------------------------------
+    /// Makes the next incremental save serialize the civilization again, the
+    /// others are copied.
+    //
+    void invalidateCiv(size_t index);
+
+    //----------------------------------------------------------------------------
+    /// Reads the objects of a section, if not done yet.
+    //
+    void loadSection(Section section);
+
+    //----------------------------------------------------------------------------
+    /// Reads all sections that haven't been read yet, with the thread pool
+    /// if more than one thread is set.
+    //
+    void loadAllSections(void);
+
+    //----------------------------------------------------------------------------
+    /// False while a lazily loaded section hasn't been completely read.
+    //
+    bool isSectionLoaded(Section section) const;
+
+    //----------------------------------------------------------------------------
+    /// Loads the file through a snapshot cache. A snapshot holds the
+    /// decompressed data and where the objects of each section are in it,
+    /// stored with offsets only, and is keyed by the size and CRC-32 of the
+    /// source file and the game version. If it is up to date, it is mapped
+    /// into memory and the sections are read from it like when loading
+    /// lazily, without decompressing the source file. Otherwise the source
+    /// file is loaded and the snapshot is rewritten. Failing to write it is
+    /// not an error.
+    ///
+    /// Sections are read according to the lazy loading and thread count
+    /// settings, the loaded data is the same as with load().
+    ///
+    /// @param fileName source file
+    /// @param snapshotFileName snapshot of the source file
+    /// @return true if the snapshot was up to date
+    /// @exception std::ios_base::failure thrown if the source file can't be
+    ///                                   read
+    //
+    bool loadWithSnapshot(const std::string &fileName, const std::string &snapshotFileName);
+
+    //----------------------------------------------------------------------------
+    /// Reads a file and passes its effects, civilizations, units and techs to
+    /// visitor as they are read, without keeping any of them. The file is
+    /// decompressed while reading, so memory use doesn't depend on its size.
+    /// Lazy loading and the thread count are ignored, and this object is left
+    /// unloaded.
+    ///
+    /// @exception std::ios_base::failure thrown if the file can't be read
+    //
+    void stream(const std::string &fileName, Visitor &visitor);
+
+    //----------------------------------------------------------------------------
+    /// Stats of the last load(), loadWithSnapshot() or stream().
+    //
+    Stats lastLoadStats(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Stats of the last save.
+    //
+    Stats lastSaveStats(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Name of a section like "Civs", for printing stats.
+    //
+    static const char *getSectionName(Section section);
+
+    //----------------------------------------------------------------------------
+    /// Returns a civilization, reading it first if needed.
+    ///
+    /// @exception std::out_of_range if there is no such civilization
+    //
+    Civ &getCiv(size_t index);
+
+    inline std::vector<TerrainRestriction> &getTerrainRestrictions(void)
+    {
+        loadSection(SECTION_TERRAIN_RESTRICTIONS);
+        return TerrainRestrictions;
+    }
+
+    inline std::vector<PlayerColour> &getPlayerColours(void)
+    {
+        loadSection(SECTION_PLAYER_COLOURS);
+        return PlayerColours;
+    }
+
+    inline std::vector<Sound> &getSounds(void)
+    {
+        loadSection(SECTION_SOUNDS);
+        return Sounds;
+    }
+
+    inline std::vector<Graphic> &getGraphics(void)
+    {
+        loadSection(SECTION_GRAPHICS);
+        return Graphics;
+    }
+
+    inline genie::TerrainBlock &getTerrainBlock(void)
+    {
+        loadSection(SECTION_TERRAIN_BLOCK);
+        return TerrainBlock;
+    }
+
+    inline genie::RandomMaps &getRandomMaps(void)
+    {
+        loadSection(SECTION_RANDOM_MAPS);
+        return RandomMaps;
+    }
+
+    inline std::vector<Effect> &getEffects(void)
+    {
+        loadSection(SECTION_EFFECTS);
+        return Effects;
+    }
+
+    inline std::vector<UnitLine> &getUnitLines(void)
+    {
+        loadSection(SECTION_UNIT_LINES);
+        return UnitLines;
+    }
+
+    inline std::vector<UnitHeader> &getUnitHeaders(void)
+    {
+        loadSection(SECTION_UNIT_HEADERS);
+        return UnitHeaders;
+    }
+
+    inline std::vector<Civ> &getCivs(void)
+    {
+        loadSection(SECTION_CIVS);
+        return Civs;
+    }
+
+    inline std::vector<Tech> &getTechs(void)
+    {
+        loadSection(SECTION_TECHS);
+        return Techs;
+    }
+
+    inline genie::TechTree &getTechTree(void)
+    {
+        loadSection(SECTION_TECH_TREE);
+        return TechTree;
+    }
+
     // File data
     static const unsigned short FILE_VERSION_SIZE = 8;
     std::string FileVersion;
@@ -132,6 +451,120 @@ private:
 
     Compressor compressor_;
 
+    bool decompressToMemory_ = true;
+
+    size_t threadCount_ = 1;
+    std::unique_ptr<ThreadPool> threadPool_;
+
+    /// Decompressed data while reading objects is deferred to the thread pool
+    /// or until they are accessed.
+    MemoryStreamBuf *deferredData_ = nullptr;
+
+    /// Reads running on the thread pool.
+    std::vector<std::future<void>> pendingReads_;
+
+    /// Objects of a section that are read once accessed.
+    struct LazyRead {
+        size_t first;
+        size_t count;
+        std::function<void()> read;
+    };
+
+    bool lazyLoading_ = false;
+    Section currentSection_ = SECTION_TERRAIN_RESTRICTIONS;
+
+    /// Decompressed data the lazy reads read from.
+    std::vector<uint8_t> lazyData_;
+    std::array<std::vector<LazyRead>, SECTION_COUNT> lazyReads_;
+
+    /// Objects read together, relative to the start of the decompressed data
+    struct SnapshotRange {
+        uint32_t section;
+        uint32_t first;
+        uint32_t count;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    /// What a snapshot is valid for
+    struct SnapshotKey {
+        uint64_t sourceSize;
+        uint32_t sourceCrc;
+        uint32_t gameVersion;
+    };
+
+    enum SnapshotState {
+        SNAPSHOT_NONE = 0,
+        SNAPSHOT_RECORD, ///< Loading the source file and keeping the ranges
+        SNAPSHOT_REPLAY ///< Loading a snapshot using its ranges
+    };
+
+    SnapshotState snapshotState_ = SNAPSHOT_NONE;
+    std::vector<SnapshotRange> snapshotRanges_;
+    size_t nextSnapshotRange_ = 0;
+
+    /// Mapped snapshot the lazy reads read from, instead of lazyData_.
+    std::unique_ptr<MappedFile> snapshotData_;
+
+    /// Receives the objects instead of this file while streaming.
+    Visitor *visitor_ = nullptr;
+
+    /// Serialized data of the sections, for saving incrementally.
+    struct SectionCache {
+        /// Where some serialized objects are in data
+        struct Range {
+            size_t offset = 0;
+            size_t size = 0;
+            bool valid = false;
+        };
+
+        GameVersion gameVersion = GV_None;
+        std::vector<uint8_t> data;
+        std::array<Range, SECTION_COUNT> sections;
+        std::vector<Range> civs;
+    };
+
+    bool incrementalSaving_ = false;
+
+    /// Data of the last load or save.
+    SectionCache sectionCache_;
+
+    /// Where the sections are in the data being read or written, nullptr if
+    /// that isn't recorded.
+    SectionCache *recording_ = nullptr;
+
+    /// Decompressed data being read while recording.
+    const MemoryStreamBuf *recordedData_ = nullptr;
+
+    bool sectionOpen_ = false;
+    size_t sectionStart_ = 0;
+
+    Stats loadStats_;
+    Stats saveStats_;
+
+    /// Stats of the load or save running, nullptr outside of serializeData()
+    /// and while calculating the size.
+    Stats *stats_ = nullptr;
+
+    /// Where the current section started, for its stats
+    struct StatsStart {
+        std::chrono::steady_clock::time_point time;
+        uint64_t position = 0;
+        uint64_t allocations = 0;
+        bool open = false;
+    };
+
+    StatsStart statsStart_;
+
+    /// Added to by the deferred reads of each section, which may run at the
+    /// same time.
+    struct DeferredStats {
+        std::atomic<uint64_t> nanoseconds{ 0 };
+        std::atomic<uint64_t> allocations{ 0 };
+    };
+
+    std::array<DeferredStats, SECTION_COUNT> deferredStats_;
+
     DatFile(const DatFile &other);
     DatFile &operator=(const DatFile &other);
 
@@ -141,6 +574,120 @@ private:
     void unload(void) override;
 
     void serializeObject(void) override;
+
+    //----------------------------------------------------------------------------
+    /// Serializes everything in the compressed part of the file.
+    //
+    void serializeData(void);
+
+    //----------------------------------------------------------------------------
+    /// Marks the start of a section in serializeData(). When saving
+    /// incrementally, a valid cached section is written here.
+    ///
+    /// @return false if the section was written and needs to be skipped
+    //
+    bool beginSection(Section section);
+
+    //----------------------------------------------------------------------------
+    /// Marks the end of the last section in serializeData().
+    //
+    void endSection(void);
+
+    //----------------------------------------------------------------------------
+    /// Position in the decompressed data being recorded.
+    //
+    size_t recordPosition(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Position in the decompressed data being read or written, for the
+    /// stats. 0 if the stream can't tell it.
+    //
+    uint64_t statsPosition(void);
+
+    //----------------------------------------------------------------------------
+    /// Adds what was spent since the start of the current section to its
+    /// stats.
+    //
+    void endSectionStats(void);
+
+    //----------------------------------------------------------------------------
+    /// Writes a part of the cached data.
+    //
+    void writeCached(const SectionCache::Range &range);
+
+    //----------------------------------------------------------------------------
+    /// Serializes the civilizations one by one, recording where each of them
+    /// is and writing the valid cached ones.
+    //
+    void serializeCivs(size_t count);
+
+    //----------------------------------------------------------------------------
+    /// Serializes a vector of objects. When loading with multiple threads or
+    /// lazily, the objects are only skipped here and read later.
+    ///
+    /// @param pointers if set, objects with a 0 pointer aren't serialized
+    //
+    template <typename T>
+    void serializeObjects(std::vector<T> &objects, size_t count,
+                          std::vector<int32_t> *pointers = nullptr);
+
+    //----------------------------------------------------------------------------
+    /// Serializes a single object like serializeObjects().
+    //
+    template <typename T>
+    void serializeSingle(T &object);
+
+    //----------------------------------------------------------------------------
+    /// Skips over objects, and queues reading them. The reads look the
+    /// objects up in the vector once they run, and fail if it was resized.
+    ///
+    /// @param objects vector with the objects, or nullptr for a single one
+    /// @param single the object if there is no vector
+    //
+    template <typename T>
+    void deferObjects(std::vector<T> *objects, T *single, size_t count,
+                      const std::vector<int32_t> *pointers);
+
+    //----------------------------------------------------------------------------
+    /// Reads objects one by one into a single object and passes them to the
+    /// visitor.
+    //
+    template <typename T>
+    void streamObjects(size_t count, const std::vector<int32_t> *pointers);
+
+    //----------------------------------------------------------------------------
+    /// Loads the data and ranges of a snapshot, if it has the given key.
+    ///
+    /// @return false if the snapshot doesn't exist or is out of date
+    //
+    bool loadSnapshot(const std::string &snapshotFileName, const SnapshotKey &key);
+
+    //----------------------------------------------------------------------------
+    /// Writes the data and ranges recorded while loading the source file.
+    //
+    void writeSnapshot(const std::string &snapshotFileName, const SnapshotKey &key);
+
+    //----------------------------------------------------------------------------
+    /// Creates the thread pool for the current thread count if needed.
+    //
+    ThreadPool &threadPool(void);
+
+    //----------------------------------------------------------------------------
+    /// Drops the lazy reads and the data they read from.
+    //
+    void clearLazyReads(void);
+
+    //----------------------------------------------------------------------------
+    /// Frees the data of the lazy reads once all of them are done.
+    //
+    void releaseLazyData(void);
+
+    //----------------------------------------------------------------------------
+    /// Waits for the reads on the thread pool to finish.
+    ///
+    /// @return the first exception thrown by a read, if any
+    //
+    std::exception_ptr waitForReads(void);
 };
 } // namespace genie
 
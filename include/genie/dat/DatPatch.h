@@ -0,0 +1,165 @@
+/*
+    Object-level differences between two DAT files
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_DATPATCH_H
+#define GENIE_DATPATCH_H
+
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "genie/file/IFile.h"
+#include "DatFile.h"
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Differences between the objects of two DAT files of the same game version,
+/// which turn the first one into the second one. Patches are compared and
+/// applied object by object on the serialized data of each object, so
+/// applying one only reads and writes the objects it changes, instead of
+/// loading the whole patched file.
+///
+/// The file format is:
+///   "GDATPTCH", uint32 version, uint32 game version, uint32 entry count,
+///   entries of uint8 object type, uint32 civ, uint32 index, uint32 change
+///   count, changes of uint32 offset, uint32 size and the bytes before,
+///   uint32 size and the bytes after.
+//
+class DatPatch : public IFile
+{
+public:
+    /// Objects a patch changes
+    enum ObjectType : uint8_t {
+        OBJECT_FILE = 0, ///< Fields of the file itself, including all object counts
+        OBJECT_TERRAIN_RESTRICTION,
+        OBJECT_PLAYER_COLOUR,
+        OBJECT_SOUND,
+        OBJECT_GRAPHIC,
+        OBJECT_TERRAIN_BLOCK,
+        OBJECT_RANDOM_MAPS,
+        OBJECT_EFFECT,
+        OBJECT_UNIT_LINE,
+        OBJECT_UNIT_HEADER,
+        OBJECT_CIV, ///< A civilization without its units, including their count
+        OBJECT_UNIT,
+        OBJECT_TECH,
+        OBJECT_TECH_TREE,
+        OBJECT_TYPE_COUNT
+    };
+
+    /// Bytes of a serialized object that are replaced
+    struct Change {
+        /// Where the bytes start in the serialized object of the base file
+        uint32_t offset = 0;
+
+        std::vector<uint8_t> before;
+        std::vector<uint8_t> after;
+    };
+
+    /// Changes of one object
+    struct Entry {
+        ObjectType type = OBJECT_FILE;
+
+        /// Civilization of a unit
+        uint32_t civ = 0;
+
+        /// Index of the object in its vector
+        uint32_t index = 0;
+
+        std::vector<Change> changes;
+    };
+
+    //----------------------------------------------------------------------------
+    /// Serialized objects of a base file. Patches from the same base to many
+    /// variants are created faster from this, as only the variants are
+    /// serialized then.
+    //
+    class Base
+    {
+    public:
+        //--------------------------------------------------------------------------
+        /// Serializes all objects of dat, loading it completely first.
+        //
+        explicit Base(DatFile &dat);
+
+        GameVersion getGameVersion(void) const;
+
+    private:
+        friend class DatPatch;
+
+        /// Where an object is in data_
+        struct Range {
+            size_t offset = 0;
+            size_t size = 0;
+        };
+
+        GameVersion gameVersion_;
+        std::vector<uint8_t> data_;
+        std::array<std::vector<Range>, OBJECT_TYPE_COUNT> objects_;
+
+        /// Ranges of the units of each civilization
+        std::vector<std::vector<Range>> units_;
+    };
+
+    //----------------------------------------------------------------------------
+    /// Replaces the entries with the differences from base to target, which
+    /// are loaded completely first.
+    ///
+    /// @exception std::ios_base::failure thrown if the game versions differ
+    //
+    void create(DatFile &base, DatFile &target);
+    void create(const Base &base, DatFile &target);
+
+    //----------------------------------------------------------------------------
+    /// Applies the entries to a file loaded from the base file. Only the
+    /// changed objects are accessed, so lazily loaded sections and
+    /// civilizations that aren't changed stay unloaded. The changed objects
+    /// are invalidated for saving incrementally.
+    ///
+    /// @exception std::ios_base::failure thrown if the game version differs
+    ///                                   or an object doesn't match the one
+    ///                                   of the base file. The objects
+    ///                                   before it are already patched then.
+    //
+    void apply(DatFile &dat) const;
+
+    //----------------------------------------------------------------------------
+    const std::vector<Entry> &getEntries(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Writes one line per change, like
+    /// "Civs[3].Units[74] +0x1c: 3c 00 00 00 -> 41 00 00 00".
+    //
+    void print(std::ostream &out) const;
+
+    //----------------------------------------------------------------------------
+    /// Path of an object like "Civs[3].Units[74]".
+    //
+    static std::string getObjectName(const Entry &entry);
+
+private:
+    std::vector<Entry> entries_;
+
+    void serializeObject(void) override;
+    void unload(void) override;
+};
+} // namespace genie
+
+#endif // GENIE_DATPATCH_H
@@ -260,14 +260,9 @@ enum ResourceStoreMode {
 /// for ResourceUsage members.
 //
 template <typename A, typename E>
-class Resource : public ISerializable
+class Resource
 {
 public:
-    void setGameVersion(GameVersion gv) override
-    {
-        ISerializable::setGameVersion(gv);
-    }
-
     int16_t Type = -1;
 
     /// Amount of the resource available/required/used
@@ -276,12 +271,11 @@ public:
     /// Bool that determines whether it is paid or only needed.
     E Paid = 0;
 
-private:
-    void serializeObject(void) override
+    void serializeFields(RecordArchive &archive)
     {
-        serialize<int16_t>(Type);
-        serialize<A>(Amount);
-        serialize<E>(Paid);
+        archive(Type);
+        archive(Amount);
+        archive(Paid);
     }
 };
 } // namespace genie
@@ -29,7 +29,8 @@ namespace genie {
 class TerrainRestriction : public ISerializable
 {
 public:
-    TerrainRestriction();
+    /// @param terrainCount amount of terrains to create entries for
+    explicit TerrainRestriction(unsigned short terrainCount = 0);
     void setGameVersion(GameVersion gv) override;
 
     /// Accessibility and Damage Multiplier
@@ -47,11 +48,7 @@ public:
 
     std::vector<TerrainPassGraphic> TerrainPassGraphics;
 
-    static void setTerrainCount(unsigned short cnt);
-
 private:
-    static unsigned short terrain_count_;
-
     void serializeObject(void) override;
 };
 } // namespace genie
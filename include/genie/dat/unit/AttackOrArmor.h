@@ -27,7 +27,7 @@ namespace genie {
 namespace unit {
 
 /// Stores information about the class and amount of an armor or attack
-class AttackOrArmor : public ISerializable
+class AttackOrArmor
 {
 public:
     enum Class {
@@ -67,8 +67,7 @@ public:
     int16_t Class = -1;
     int16_t Amount = 0;
 
-private:
-    void serializeObject(void) override;
+    void serializeFields(RecordArchive &archive);
 };
 } // namespace unit
 } // namespace genie
@@ -30,8 +30,6 @@ namespace unit {
 class Combat : public ISerializable
 {
 public:
-    void setGameVersion(GameVersion gv) override;
-
     /// This armor is used for attack types that have no corresponding armor type
     /// Can be negative only in The Conquerors and later games
     int16_t BaseArmor = 1000; // uint8_t below TC
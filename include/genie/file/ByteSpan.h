@@ -0,0 +1,91 @@
+/*
+    Read-only view of bytes owned by someone else
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_BYTESPAN_H
+#define GENIE_BYTESPAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Read-only view of bytes owned by someone else, like a mapped file. Whoever
+/// hands one out says how long it stays valid.
+//
+class ByteSpan
+{
+public:
+    ByteSpan() = default;
+
+    ByteSpan(const uint8_t *data, size_t size) :
+        data_(data),
+        size_(size)
+    {
+    }
+
+    inline const uint8_t *data() const
+    {
+        return data_;
+    }
+
+    inline size_t size() const
+    {
+        return size_;
+    }
+
+    inline bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    inline const uint8_t *begin() const
+    {
+        return data_;
+    }
+
+    inline const uint8_t *end() const
+    {
+        return data_ + size_;
+    }
+
+    inline uint8_t operator[](size_t index) const
+    {
+        return data_[index];
+    }
+
+    //----------------------------------------------------------------------------
+    /// Part of the view, cut off at its end.
+    //
+    inline ByteSpan subspan(size_t offset, size_t count) const
+    {
+        if (offset > size_) {
+            return ByteSpan();
+        }
+
+        return ByteSpan(data_ + offset, count < size_ - offset ? count : size_ - offset);
+    }
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace genie
+
+#endif // GENIE_BYTESPAN_H
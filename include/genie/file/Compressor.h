@@ -20,12 +20,56 @@
 #ifndef GENIE_COMPRESSOR_H
 #define GENIE_COMPRESSOR_H
 
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <vector>
 #include "ISerializable.h"
+#include "MemoryStreamBuf.h"
 
 namespace genie {
 
+class ThreadPool;
+
+//------------------------------------------------------------------------------
+/// Progress of inflating data with Compressor::decompress().
+//
+struct DecompressProgress
+{
+    /// Compressed bytes inflated so far
+    uint64_t compressedBytes = 0;
+
+    /// Bytes written so far
+    uint64_t decompressedBytes = 0;
+
+    /// Seconds since inflating started
+    double seconds = 0;
+
+    /// Set in the last report, when all data is written
+    bool finished = false;
+
+    /// Inflated megabytes per second
+    inline double megabytesPerSecond(void) const
+    {
+        return seconds > 0 ? decompressedBytes / (1024.0 * 1024.0) / seconds : 0;
+    }
+};
+
+typedef std::function<void(const DecompressProgress &)> DecompressProgressCallback;
+
+//------------------------------------------------------------------------------
+/// How Compressor::decompress() writes a file.
+//
+struct DecompressOptions
+{
+    /// Writes into a memory mapping of the output file instead of through
+    /// write calls, which saves copying the inflated data once.
+    bool mapOutput = false;
+
+    /// Called every few MB and once when done.
+    DecompressProgressCallback progress;
+};
+
 //------------------------------------------------------------------------------
 /// Utility to compress and decompress streams handled in ISerializeable
 /// objects.
@@ -47,10 +91,68 @@ public:
     void beginCompression(void);
 
     //----------------------------------------------------------------------------
+    /// @exception std::ios_base::failure thrown if compressing with the thread
+    ///                                   pool failed, the output is cut off then
+    //
     void endCompression(void);
 
     //----------------------------------------------------------------------------
-    static void decompress(std::istream &source, std::ostream &sink);
+    /// If enabled, the whole stream is decompressed into memory with a single
+    /// inflate call when reading begins, instead of through a stream buffer
+    /// while reading. The object then reads from a MemoryStreamBuf that
+    /// stays valid until endCompression(). Enabled by default, disabling it
+    /// only keeps a 1 MB window of the data in memory.
+    //
+    void setDecompressToMemory(bool inMemory);
+
+    //----------------------------------------------------------------------------
+    /// Takes over the data decompressed into memory, so that it stays valid
+    /// after endCompression().
+    //
+    std::vector<uint8_t> takeDecompressedData(void);
+
+    //----------------------------------------------------------------------------
+    /// Sets the zlib compression level used for writing, from 0 (stored) to 9
+    /// (smallest). The default is -1, zlib's default level 6.
+    //
+    void setCompressionLevel(int level);
+
+    //----------------------------------------------------------------------------
+    int getCompressionLevel(void) const;
+
+    //----------------------------------------------------------------------------
+    /// If a pool is set, written data is collected in memory and compressed
+    /// in chunks by the pool and the calling thread, like pigz does. Each
+    /// chunk is primed with the end of the previous one and byte aligned with
+    /// a sync flush, so they join into one raw deflate stream that any
+    /// inflater reads like a stream compressed at once. Without a pool, data
+    /// is compressed on the calling thread while it is written.
+    ///
+    /// @param pool pool to compress with, it has to outlive the compression
+    //
+    void setThreadPool(ThreadPool *pool);
+
+    //----------------------------------------------------------------------------
+    /// Inflates the rest of source into sink, in large blocks at the speed
+    /// of zlib.
+    ///
+    /// @exception std::ios_base::failure thrown if the data is corrupt or
+    ///                                   truncated, or sink fails
+    //
+    static void decompress(std::istream &source, std::ostream &sink,
+                           const DecompressProgressCallback &progress = DecompressProgressCallback());
+
+    //----------------------------------------------------------------------------
+    /// Inflates the rest of source into a new file.
+    ///
+    /// @param header uncompressed data written before the inflated data
+    /// @exception std::ios_base::failure thrown if the data is corrupt or
+    ///                                   truncated, or the file can't be
+    ///                                   written
+    //
+    static void decompress(std::istream &source, const std::string &fileName,
+                           const DecompressOptions &options,
+                           const std::string &header = std::string());
 
 private:
     ISerializable *obj_ = nullptr;
@@ -58,9 +160,20 @@ private:
     std::istream *istream_ = nullptr;
     std::shared_ptr<std::istream> uncompressedIstream_;
 
+    bool decompressToMemory_ = true;
+    std::vector<uint8_t> decompressed_;
+    MemoryStreamBuf decompressedBuf_;
+
     std::ostream *ostream_ = nullptr;
     std::shared_ptr<std::ostream> bufferedStream_;
 
+    int compressionLevel_ = -1;
+    ThreadPool *threadPool_ = nullptr;
+
+    /// Written data collected for compressing it in parallel.
+    std::vector<uint8_t> written_;
+    std::unique_ptr<VectorStreamBuf> writeBuffer_;
+
     Compressor() = default;
 
     //----------------------------------------------------------------------------
@@ -68,6 +181,11 @@ private:
     //
     void startDecompression(void);
 
+    //----------------------------------------------------------------------------
+    /// Inflates the rest of istream into decompressed_.
+    //
+    void inflateToMemory(void);
+
     //----------------------------------------------------------------------------
     /// Closes decompressed stream.
     //
@@ -78,6 +196,12 @@ private:
 
     //----------------------------------------------------------------------------
     void stopCompression(void);
+
+    //----------------------------------------------------------------------------
+    /// Compresses the collected data in chunks with the thread pool and
+    /// writes the joined stream to ostream_.
+    //
+    void compressParallel(void);
 };
 } // namespace genie
 
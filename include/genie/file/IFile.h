@@ -21,9 +21,14 @@
 #ifndef GENIE_IFILE_H
 #define GENIE_IFILE_H
 
+#include "ByteSpan.h"
 #include "ISerializable.h"
+#include "IoStats.h"
+#include "MappedFile.h"
+#include "MemoryStreamBuf.h"
 
 #include <fstream>
+#include <memory>
 
 namespace genie {
 
@@ -33,7 +38,13 @@ namespace genie {
 class IFile : public ISerializable
 {
 public:
-    IFile() = default;
+    /// How the file is accessed when loading
+    enum LoadMode {
+        LOAD_STREAM = 0, ///< Read through a std::ifstream (default)
+        LOAD_MAPPED = 1 ///< Map the file into memory and read directly from it
+    };
+
+    IFile();
 
     IFile(const IFile &) = delete;
     IFile &operator=(const IFile &) = delete;
@@ -56,8 +67,23 @@ public:
     //
     const char *getFileName(void) const;
 
+    //----------------------------------------------------------------------------
+    /// Sets how the file is accessed by the following loads. A mapped file
+    /// stays mapped until the file is loaded again, freelock() is called or
+    /// the object is destroyed.
+    ///
+    /// @param mode load mode
+    //
+    void setLoadMode(LoadMode mode);
+
+    //----------------------------------------------------------------------------
+    /// @return how the file is accessed when loading
+    //
+    LoadMode getLoadMode(void) const;
+
     //----------------------------------------------------------------------------
     /// Loads the object from file. Can only be called if fileName is already set.
+    /// While IoStats is enabled, the reads and seeks on the file are counted.
     ///
     /// @exception std::ios_base::failure thrown if file can't be read (file
     ///                                   doesn't exist, insufficient rights...)
@@ -88,7 +114,8 @@ public:
     ///
     /// @param fileName file name
     /// @exception std::ios_base::failure thrown if file can't be written (
-    ///                                   insufficient rights...)
+    ///                                   insufficient rights, compression
+    ///                                   failed...)
     //
     virtual void saveAs(const char *fileName);
 
@@ -99,12 +126,42 @@ protected:
     //
     virtual void unload();
 
+    //----------------------------------------------------------------------------
+    /// The whole file while it is mapped by a load with LOAD_MAPPED, empty
+    /// otherwise.
+    //
+    ByteSpan getMappedData(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Each file has its own versions, shared by all its subobjects.
+    //
+    SerializationContext *ownContext(void) override
+    {
+        return &serializationContext_;
+    }
+
 private:
     std::string fileName_;
 
+    SerializationContext serializationContext_;
+
     std::ifstream fileIn_;
 
+    LoadMode loadMode_ = LOAD_STREAM;
+
+    MappedFile mappedFile_;
+    MemoryStreamBuf mappedBuf_;
+    std::istream mappedIn_;
+
+    /// Reads from fileIn_ or mappedIn_ while IoStats is enabled
+    std::unique_ptr<InstrumentedIStream> instrumentedIn_;
+
     bool loaded_ = false;
+
+    //----------------------------------------------------------------------------
+    /// Returns the stream to read from source through.
+    //
+    std::istream &inputStream(std::istream &source);
 };
 } // namespace genie
 
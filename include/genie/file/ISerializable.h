@@ -22,10 +22,13 @@
 #define GENIE_ISERIALIZABLE_H
 
 #include "genie/Types.h"
+#include "genie/file/MemoryStreamBuf.h"
 
 #include <iostream>
 
 #include <array>
+#include <memory>
+#include <type_traits>
 #include <vector>
 #include <string.h>
 #include <stdint.h>
@@ -33,6 +36,79 @@
 
 namespace genie {
 
+//------------------------------------------------------------------------------
+/// Versions and counts read from a file that decide how the rest of it is
+/// laid out. Each root file owns one, and shares it with its subobjects while
+/// serializing, so several files can be processed at the same time.
+//
+struct SerializationContext
+{
+    /// Internal genie version in the DAT file, values between 6 to 12
+    float dat_internal_ver = 0.f;
+
+    /// Terrain count of the terrain restrictions in the DAT file
+    unsigned short terrain_restriction_count = 0;
+
+    /// Scenario file version; "1.00" to "1.21"
+    std::string scn_ver = "0.00";
+
+    /// Internal genie PLR version 1.0 to 1.30
+    float scn_plr_data_ver = 0.f;
+
+    /// Internal scenario file version
+    float scn_internal_ver = 0.f;
+
+    /// Scenario trigger version 1.0 to 1.6
+    double scn_trigger_ver = 0.0;
+
+    /// Whether player info or player resources are serialized
+    bool scn_player_info = false;
+};
+
+class ISerializable;
+
+//------------------------------------------------------------------------------
+/// Serializes the fields of a record with the stream and operation of the
+/// object the record is part of.
+///
+/// Records are small structs that appear many times in a file, like map
+/// tiles or resource costs. They don't inherit from ISerializable, so they
+/// only contain their fields, and implement
+///
+///     void serializeFields(RecordArchive &archive)
+///
+/// which calls archive(field) for each field in file order.
+//
+class RecordArchive
+{
+public:
+    explicit RecordArchive(ISerializable &owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Reads, writes or counts field, depending on the operation of the owner.
+    template <typename T>
+    inline void operator()(T &field);
+
+    /// Game version of the object the record is part of
+    inline GameVersion getGameVersion(void) const;
+
+private:
+    ISerializable &owner_;
+};
+
+/// Whether T is a record, see RecordArchive.
+template <typename T, typename = void>
+struct IsRecord : std::false_type
+{
+};
+
+template <typename T>
+struct IsRecord<T, std::void_t<decltype(std::declval<T &>().serializeFields(std::declval<RecordArchive &>()))>> : std::true_type
+{
+};
+
 //------------------------------------------------------------------------------
 /// Generic base class for genie file serialization
 //
@@ -40,18 +116,24 @@ class ISerializable
 {
 
 public:
+    ISerializable() = default;
     virtual ~ISerializable() = default;
 
+    /// Copies only the version and read position, copies aren't part of the
+    /// serialization the original was part of.
+    ISerializable(const ISerializable &other) noexcept;
+    ISerializable &operator=(const ISerializable &other) noexcept;
+
     /// Set position to start reading the object from stream
     inline void setInitialReadPosition(std::streampos pos)
     {
-        init_read_pos_ = pos;
+        init_read_pos_ = std::streamoff(pos);
     }
 
     /// Where in the input stream this object is starting at
     inline std::streampos getInitialReadPosition(void) const
     {
-        return init_read_pos_;
+        return std::streampos(init_read_pos_);
     }
 
     /// Read object from istream.
@@ -64,7 +146,8 @@ public:
     /// @param ostr Output stream to write to
     void writeObject(std::ostream &ostr);
 
-    /// Returns size in bytes.
+    /// Returns size in bytes. The size is computed in a single pass over the
+    /// object and all its subobjects.
     virtual size_t objectSize(void);
 
     /// Serialize this object as a subobject of another one.
@@ -88,35 +171,27 @@ public:
     template <typename T>
     static void updateGameVersion(GameVersion gv, std::vector<T> &vec)
     {
+        static_assert(std::is_base_of<ISerializable, T>::value, "T needs to be serializable");
+
         for (T &it : vec) {
-            ISerializable *item = dynamic_cast<ISerializable *>(&it);
-            item->setGameVersion(gv);
+            it.setGameVersion(gv);
         }
     }
 
     /// Needs access to get and set stream methods for (de)compressing.
     friend class Compressor;
 
-    /// Versions used to read/write/paste.
+    /// Serializes the fields of records with the state of this object.
+    friend class RecordArchive;
 
-    /// Internal genie version in the DAT file, values between 6 to 12
-    static float dat_internal_ver;
-
-    /// Scenario file version; "1.00" to "1.21"
-    static std::string scn_ver;
-
-    /// Internal genie PLR version 1.0 to 1.30
-    static float scn_plr_data_ver;
-
-    /// Internal scenario file version
-    static float scn_internal_ver;
-
-    /// Scenario trigger version 1.0 to 1.6
-    static double scn_trigger_ver;
+    /// Versions of the file this object is being serialized as part of.
+    /// Only valid during serialization, objects without a root file share
+    /// a per thread context.
+    SerializationContext &context(void);
 
 protected:
     /// Defines the current operation when serializing
-    enum Operation {
+    enum Operation : int8_t {
         OP_INVALID = -1,
         OP_READ = 0,
         OP_WRITE = 1,
@@ -131,13 +206,36 @@ protected:
         updateGameVersion<T>(getGameVersion(), vec);
     }
 
+    //----------------------------------------------------------------------------
+    /// Serializes object as a subobject of this one, like
+    /// object.serializeSubObject(this), without casting it first.
+    //
+    template <typename T>
+    inline void serializeSub(T &object)
+    {
+        static_assert(std::is_base_of<ISerializable, T>::value, "T needs to be serializable");
+
+        ISerializable &sub = object;
+
+        // The state is only valid while the object it belongs to serializes.
+        StateGuard guard(sub, state_);
+
+        // Objects pass their version on to their subobjects, which is only
+        // needed once.
+        if (sub.gameVersion_ != gameVersion_) {
+            object.setGameVersion(gameVersion_);
+        }
+
+        sub.serializeObject();
+    }
+
     //----------------------------------------------------------------------------
     /// Set operation to process
     ///
     /// @param op operation
     inline void setOperation(Operation op)
     {
-        operation_ = op;
+        ownState().operation = op;
     }
 
     //----------------------------------------------------------------------------
@@ -146,7 +244,7 @@ protected:
     /// @return operation
     inline Operation getOperation(void) const
     {
-        return operation_;
+        return state_ ? state_->operation : OP_INVALID;
     }
 
     //----------------------------------------------------------------------------
@@ -155,32 +253,55 @@ protected:
     /// @param op operation to check
     inline bool isOperation(Operation op) const
     {
-        assert(operation_ != OP_INVALID);
-        return (op == operation_);
+        assert(state_->operation != OP_INVALID);
+        return (op == state_->operation);
+    }
+
+    //----------------------------------------------------------------------------
+    /// While skipping, reading only goes as far as needed to find where the
+    /// data ends. Strings and arrays are passed over without storing them.
+    /// Counts and other fields are still read, as the layout depends on
+    /// them. The objects read are only good for skipping more.
+    //
+    inline void setSkipping(bool skipping)
+    {
+        ownState().skipping = skipping;
     }
 
-    /// Sets the stream the data should be read from
+    /// Sets the stream the data should be read from. If the stream reads
+    /// from memory, the data is read directly from its buffer.
     inline void setIStream(std::istream &istr)
     {
-        istr_ = &istr;
+        State &state = ownState();
+        state.istr = &istr;
+        state.membuf = dynamic_cast<MemoryStreamBuf *>(istr.rdbuf());
+    }
+
+    /// Forgets the stream data is read from, for streams that don't outlive
+    /// reading the object.
+    inline void clearIStream(void)
+    {
+        State &state = ownState();
+        state.istr = nullptr;
+        state.membuf = nullptr;
     }
 
     /// Returns the current stream data is read from
     inline std::istream *getIStream(void)
     {
-        return istr_;
+        return state_ ? state_->istr : nullptr;
     }
 
     /// Sets the stream data should be saved to
     inline void setOStream(std::ostream &ostr)
     {
-        ostr_ = &ostr;
+        ownState().ostr = &ostr;
     }
 
     /// Returns the stream data is saved to
     inline std::ostream *getOStream(void)
     {
-        return ostr_;
+        return state_ ? state_->ostr : nullptr;
     }
 
     //----------------------------------------------------------------------------
@@ -203,6 +324,15 @@ protected:
     //
     virtual void serializeObject(void) = 0;
 
+    //----------------------------------------------------------------------------
+    /// Files that are the root of an object tree return the context they own,
+    /// it is then shared with all their subobjects.
+    //
+    virtual SerializationContext *ownContext(void)
+    {
+        return nullptr;
+    }
+
     //----------------------------------------------------------------------------
     /// Reads a string from istr. Returns empty string if len parameter is 0.
     /// The string will be cut at the first \0.
@@ -231,13 +361,43 @@ protected:
     {
         T ret = {};
 
-        if (!istr_->eof()) {
-            istr_->read(reinterpret_cast<char *>(&ret), sizeof(ret));
+        if (state_->membuf) {
+            readRaw(&ret, sizeof(ret));
+        } else if (!state_->istr->eof()) {
+            state_->istr->read(reinterpret_cast<char *>(&ret), sizeof(ret));
         }
 
         return ret;
     }
 
+    //----------------------------------------------------------------------------
+    /// Reads size bytes into dest, from the memory buffer if there is one.
+    //
+    inline void readRaw(void *dest, size_t size)
+    {
+        if (state_->membuf) {
+            if (!state_->membuf->take(dest, size)) {
+                state_->istr->setstate(std::ios::eofbit | std::ios::failbit);
+            }
+        } else {
+            state_->istr->read(reinterpret_cast<char *>(dest), size);
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    /// Moves the read position size bytes ahead.
+    //
+    inline void skipRaw(size_t size)
+    {
+        if (state_->membuf) {
+            if (!state_->membuf->skip(size)) {
+                state_->istr->setstate(std::ios::eofbit | std::ios::failbit);
+            }
+        } else {
+            state_->istr->ignore(size);
+        }
+    }
+
     //----------------------------------------------------------------------------
     /// Generic write method for basic data types.
     ///
@@ -248,7 +408,7 @@ protected:
               >
     void write(const T &data)
     {
-        ostr_->write(reinterpret_cast<const char *>(&data), sizeof(T));
+        state_->ostr->write(reinterpret_cast<const char *>(&data), sizeof(T));
     }
 
     //----------------------------------------------------------------------------
@@ -259,12 +419,12 @@ protected:
               >
     void read(T **array, size_t len)
     {
-        if (!istr_->eof()) {
+        if (!state_->istr->eof()) {
             if (*array == 0) {
                 *array = new T[len];
             }
 
-            istr_->read(reinterpret_cast<char *>(*array), sizeof(T) * len);
+            readRaw(*array, sizeof(T) * len);
         }
     }
 
@@ -276,7 +436,7 @@ protected:
               >
     void write(const T *const *data, size_t len)
     {
-        ostr_->write(reinterpret_cast<const char *const>(*data), sizeof(T) * len);
+        state_->ostr->write(reinterpret_cast<const char *const>(*data), sizeof(T) * len);
     }
 
     /// Serializes a string with debug data.
@@ -308,11 +468,11 @@ protected:
     template <typename T>
     void serializeForcedString(std::string &str)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         T size{};
 
-        if (isOperation(OP_WRITE)) {
+        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
             size = str.size() + 1;
         }
 
@@ -325,7 +485,7 @@ protected:
     void serializeSizedStrings(std::vector<std::string> &vec, size_t size,
                                bool cString = true)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         if (isOperation(OP_READ)) {
             vec.resize(size);
@@ -343,7 +503,7 @@ protected:
     template <typename T>
     void serialize(T &data)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         switch (getOperation()) {
         case OP_WRITE:
@@ -355,11 +515,11 @@ protected:
             break;
 
         case OP_CALC_SIZE:
-            size_ += sizeof(T);
+            state_->size += sizeof(T);
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
@@ -368,13 +528,9 @@ protected:
     template <typename T>
     void serialize(ISerializable &data)
     {
-        assert(operation_ != OP_INVALID);
-
-        data.serializeSubObject(this);
+        assert(state_->operation != OP_INVALID);
 
-        if (isOperation(OP_CALC_SIZE)) {
-            size_ += data.objectSize();
-        }
+        serializeSub(data);
     }
 
     /// Reads or writes an array of data dependent on Write_ flag.
@@ -388,15 +544,19 @@ protected:
             break;
 
         case OP_READ:
-            read<T>(data, len);
+            if (state_->skipping) {
+                skipRaw(sizeof(T) * len);
+            } else {
+                read<T>(data, len);
+            }
             break;
 
         case OP_CALC_SIZE:
-            size_ += sizeof(T) * len;
+            state_->size += sizeof(T) * len;
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
@@ -404,7 +564,7 @@ protected:
     /// Spezialization of std::strings.
     void serialize(std::string &str, size_t len)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         if (len > 0) {
             switch (getOperation()) {
@@ -413,15 +573,19 @@ protected:
                 break;
 
             case OP_READ:
-                str = readString(len);
+                if (state_->skipping) {
+                    skipRaw(len);
+                } else {
+                    str = readString(len);
+                }
                 break;
 
             case OP_CALC_SIZE:
-                size_ += sizeof(char) * len;
+                state_->size += sizeof(char) * len;
                 break;
 
             case OP_INVALID:
-                assert(operation_ != OP_INVALID);
+                assert(state_->operation != OP_INVALID);
                 break;
             }
         }
@@ -435,21 +599,21 @@ protected:
     {
         switch (getOperation()) {
         case OP_WRITE:
-            ostr_->write(reinterpret_cast<const char *const>(vec.data()), sizeof(T) *  N);
+            state_->ostr->write(reinterpret_cast<const char *const>(vec.data()), sizeof(T) *  N);
 
             break;
 
         case OP_READ:
-            istr_->read(reinterpret_cast<char *>(vec.data()), sizeof(T) * N);
+            readRaw(vec.data(), sizeof(T) * N);
 
             break;
 
         case OP_CALC_SIZE:
-            size_ += vec.size() * sizeof(T);
+            state_->size += vec.size() * sizeof(T);
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
@@ -461,29 +625,16 @@ protected:
               >
     void serialize(std::array<T, N> &vec)
     {
-        assert(operation_ != OP_INVALID);
-
-        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
-            for (typename std::array<T, N>::iterator it = vec.begin(); it != vec.end(); ++it) {
-                ISerializable *data = dynamic_cast<ISerializable *>(&(*it));
-
-                data->serializeSubObject(this);
+        assert(state_->operation != OP_INVALID);
 
-                if (isOperation(OP_CALC_SIZE)) {
-                    size_ += data->objectSize();
-                }
-            }
-        } else {
-            for (size_t i = 0; i < N; ++i) {
-                ISerializable *cast_obj = dynamic_cast<ISerializable *>(&vec[i]);
-                cast_obj->serializeSubObject(this);
-            }
+        for (T &item : vec) {
+            serializeSub(item);
         }
     }
 
     /// Reads or writes an array of data to/from a vector dependent on operation.
     template <typename T,
-              std::enable_if_t<std::is_pod<T>::value, int> = 0
+              std::enable_if_t<std::is_pod<T>::value && !IsRecord<T>::value, int> = 0
               >
     void serialize(std::vector<T> &vec, size_t size)
     {
@@ -492,21 +643,21 @@ protected:
             if (vec.size() != size) {
                 std::cerr << "Warning!: vector size differs len!" << vec.size() << " " << size << std::endl;
             }
-            ostr_->write(reinterpret_cast<const char *const>(vec.data()), sizeof(T) * std::min(size, vec.size()));
+            state_->ostr->write(reinterpret_cast<const char *const>(vec.data()), sizeof(T) * std::min(size, vec.size()));
             break;
 
         case OP_READ:
             vec.resize(size);
-            istr_->read(reinterpret_cast<char *>(vec.data()), sizeof(T) * size);
+            readRaw(vec.data(), sizeof(T) * size);
 
             break;
 
         case OP_CALC_SIZE:
-            size_ += size * sizeof(T);
+            state_->size += size * sizeof(T);
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
@@ -530,11 +681,21 @@ protected:
             break;
 
         case OP_READ:
+            if (state_->skipping) {
+                skipRaw(size * size2 * sizeof(T));
+                break;
+            }
+
             vec.resize(size);
 
             for (size_t i = 0; i < size; ++i) {
                 vec[i].resize(size2);
 
+                if (state_->membuf) {
+                    readRaw(vec[i].data(), sizeof(T) * size2);
+                    continue;
+                }
+
                 for (size_t j = 0; j < size2; ++j) {
                     vec[i][j] = read<T>();
                 }
@@ -543,11 +704,11 @@ protected:
             break;
 
         case OP_CALC_SIZE:
-            size_ += size * size2 * sizeof(T);
+            state_->size += size * size2 * sizeof(T);
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
@@ -558,41 +719,58 @@ protected:
               >
     void serialize(std::vector<T> &vec, size_t size)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
             if (vec.size() != size) {
                 std::cerr << "Warning!: vector size differs size!" << vec.size() << " " << size << std::endl;
             }
 
-            for (typename std::vector<T>::iterator it = vec.begin(); it != vec.end(); ++it) {
-                ISerializable *data = static_cast<ISerializable *>(&(*it));
-
-                data->serializeSubObject(this);
-
-                if (isOperation(OP_CALC_SIZE)) {
-                    size_ += data->objectSize();
-                }
+            for (T &item : vec) {
+                serializeSub(item);
             }
         } else {
             vec.resize(size);
 
             for (size_t i = 0; i < size; ++i) {
-                assert(getIStream()->good());
-                ISerializable *cast_obj = static_cast<ISerializable *>(&vec[i]);
-                cast_obj->serializeSubObject(this);
+                assert(state_->membuf || getIStream()->good());
+                serializeSub(vec[i]);
             }
         }
     }
 
+    /// Serializes a vector of records, see RecordArchive.
+    template <typename T,
+              std::enable_if_t<IsRecord<T>::value, int> = 0
+              >
+    void serialize(std::vector<T> &vec, size_t size)
+    {
+        assert(state_->operation != OP_INVALID);
+
+        RecordArchive archive(*this);
+
+        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
+            if (vec.size() != size) {
+                std::cerr << "Warning!: vector size differs size!" << vec.size() << " " << size << std::endl;
+            }
+        } else {
+            vec.resize(size);
+        }
+
+        for (T &item : vec) {
+            item.serializeFields(archive);
+        }
+    }
+
     /// Serialize a vector size number. If size differs, the number will be
-    /// updated.
+    /// updated. The number is also needed when calculating the size, as the
+    /// vector that follows is counted by it.
     template <typename T>
     void serializeSize(T &data, size_t size)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
-        if (isOperation(OP_WRITE)) {
+        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
             data = size;
         }
 
@@ -607,10 +785,10 @@ protected:
     template <typename T>
     void serializeSize(T &data, const std::string &str, bool cString = true)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         // calculate new size
-        if (isOperation(OP_WRITE)) {
+        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
             size_t size = str.size();
 
             if (cString && size != 0) {
@@ -630,27 +808,15 @@ protected:
     void serializeSubWithPointers(std::vector<T> &vec, size_t size,
                                   std::vector<int32_t> &pointers)
     {
-        assert(operation_ != OP_INVALID);
-
-        if (isOperation(OP_WRITE) || isOperation(OP_CALC_SIZE)) {
-            for (size_t i = 0; i < size; ++i) {
-                if (pointers[i]) {
-                    ISerializable *data = dynamic_cast<ISerializable *>(&vec[i]);
-                    data->serializeSubObject(this);
+        assert(state_->operation != OP_INVALID);
 
-                    if (isOperation(OP_CALC_SIZE)) {
-                        size_ += data->objectSize();
-                    }
-                }
-            }
-        } else {
+        if (isOperation(OP_READ)) {
             vec.resize(size);
+        }
 
-            for (size_t i = 0; i < size; ++i) {
-                if (pointers[i]) {
-                    ISerializable *cast_obj = dynamic_cast<ISerializable *>(&vec[i]);
-                    cast_obj->serializeSubObject(this);
-                }
+        for (size_t i = 0; i < size; ++i) {
+            if (pointers[i]) {
+                serializeSub(vec[i]);
             }
         }
     }
@@ -662,7 +828,7 @@ protected:
     template <typename T>
     void serializePair(std::pair<T, T> &p, bool only_first = false)
     {
-        assert(operation_ != OP_INVALID);
+        assert(state_->operation != OP_INVALID);
 
         switch (getOperation()) {
         case OP_WRITE:
@@ -684,33 +850,105 @@ protected:
             break;
 
         case OP_CALC_SIZE:
-            size_ += sizeof(T);
+            state_->size += sizeof(T);
 
             if (!only_first) {
-                size_ += sizeof(T);
+                state_->size += sizeof(T);
             }
 
             break;
 
         case OP_INVALID:
-            assert(operation_ != OP_INVALID);
+            assert(state_->operation != OP_INVALID);
             break;
         }
     }
 
 private:
-    std::istream *istr_ = nullptr;
-    std::ostream *ostr_ = nullptr;
+    //----------------------------------------------------------------------------
+    /// Streams and operation of one serialization. The object it is started
+    /// on owns it, and its subobjects point to it while they are serialized.
+    //
+    struct State
+    {
+        std::istream *istr = nullptr;
+        std::ostream *ostr = nullptr;
 
-    std::streampos init_read_pos_ = 0;
+        /// Buffer of istr if it reads from memory, nullptr otherwise.
+        MemoryStreamBuf *membuf = nullptr;
 
-    Operation operation_ = OP_INVALID;
+        /// Context of the root object, set when serializing starts.
+        SerializationContext *context = nullptr;
 
-    GameVersion gameVersion_ = GV_None;
+        /// Size accumulated while calculating
+        size_t size = 0;
+
+        Operation operation = OP_INVALID;
+
+        /// See setSkipping()
+        bool skipping = false;
+    };
+
+    //----------------------------------------------------------------------------
+    /// Makes this object use the state it owns, so it can be changed without
+    /// affecting the object it was serialized as part of.
+    //
+    State &ownState(void);
+
+    //----------------------------------------------------------------------------
+    /// Makes an object use the given state until the guard is destroyed, then
+    /// gives it back the state it had before, also if serializing threw.
+    //
+    class StateGuard
+    {
+    public:
+        StateGuard(ISerializable &object, State *state) :
+            object_(object),
+            previous_(object.state_)
+        {
+            object_.state_ = state;
+        }
+
+        ~StateGuard()
+        {
+            object_.state_ = previous_;
+        }
+
+        StateGuard(const StateGuard &) = delete;
+        StateGuard &operator=(const StateGuard &) = delete;
+
+    private:
+        ISerializable &object_;
+        State *previous_;
+    };
+
+    /// State of the current serialization of this object, or the state it
+    /// owns, or nullptr. Never a state of another object once that one has
+    /// finished serializing, see StateGuard.
+    State *state_ = nullptr;
 
-    size_t size_ = 0;
+    std::unique_ptr<State> ownState_;
+
+    /// Stored as an offset, the conversion state of std::streampos is never
+    /// used and would double the size.
+    std::streamoff init_read_pos_ = 0;
+
+    GameVersion gameVersion_ = GV_None;
 };
 
+//------------------------------------------------------------------------------
+template <typename T>
+inline void RecordArchive::operator()(T &field)
+{
+    owner_.serialize<T>(field);
+}
+
+//------------------------------------------------------------------------------
+inline GameVersion RecordArchive::getGameVersion(void) const
+{
+    return owner_.getGameVersion();
+}
+
 //----------------------------------------------------------------------------
 /// Copies data from src to dest, but also allocates memory for dest or
 /// sets dest to 0 if src is 0.
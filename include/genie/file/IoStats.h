@@ -0,0 +1,169 @@
+/*
+    Read and seek counters per resource type
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_IOSTATS_H
+#define GENIE_IOSTATS_H
+
+#include <array>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Counts the reads and seeks done on the streams files are loaded from, per
+/// resource type, to find the access patterns that are slow on network file
+/// systems.
+///
+/// Counting is disabled by default. While enabled, IFile::load() reads
+/// through an InstrumentedStreamBuf. I/O is counted for the resource type of the
+/// innermost Scope on the calling thread, so an SLP read from a DRS archive
+/// counts for IO_SLP and the archive's own tables for IO_DRS.
+//
+class IoStats
+{
+public:
+    /// What is being read
+    enum Resource {
+        IO_OTHER = 0, ///< Outside of any scope
+        IO_DAT,
+        IO_DRS,
+        IO_SLP,
+        IO_SMP,
+        IO_SMX,
+        IO_PALETTE,
+        IO_EDGE,
+        IO_SLP_TEMPLATE,
+        IO_RESOURCE_COUNT
+    };
+
+    struct Counters {
+        /// Calls reading from the stream buffer, a read() of any size is one
+        uint64_t readCalls = 0;
+
+        uint64_t bytesRead = 0;
+
+        /// Seeks, without the ones that only tell the position or stay where
+        /// the stream already is
+        uint64_t seeks = 0;
+
+        /// Bytes skipped over by seeking, forwards and backwards
+        uint64_t seekDistance = 0;
+    };
+
+    typedef std::array<Counters, IO_RESOURCE_COUNT> Snapshot;
+
+    //----------------------------------------------------------------------------
+    /// Sets the resource type I/O on the calling thread is counted for, until
+    /// the scope ends.
+    //
+    class Scope
+    {
+    public:
+        explicit Scope(Resource resource);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Resource previous_;
+    };
+
+    //----------------------------------------------------------------------------
+    /// Enables or disables counting for the streams opened from now on.
+    /// Streams that are already open keep counting or not.
+    //
+    static void setEnabled(bool enable);
+    static bool isEnabled(void);
+
+    //----------------------------------------------------------------------------
+    /// Counters of all threads so far. The counters of different types may be
+    /// taken at slightly different times if other threads are reading.
+    //
+    static Snapshot snapshot(void);
+
+    //----------------------------------------------------------------------------
+    /// Sets all counters to 0.
+    //
+    static void reset(void);
+
+    //----------------------------------------------------------------------------
+    /// Name of a resource type like "slp".
+    //
+    static const char *getResourceName(Resource resource);
+
+    //----------------------------------------------------------------------------
+    /// Adds to the counters of the resource type of the calling thread.
+    //
+    static void countRead(uint64_t bytes);
+    static void countSeek(uint64_t distance);
+};
+
+//------------------------------------------------------------------------------
+/// Unbuffered read-only stream buffer passing everything on to another one
+/// and counting it in IoStats.
+//
+class InstrumentedStreamBuf : public std::streambuf
+{
+public:
+    explicit InstrumentedStreamBuf(std::streambuf &target);
+
+    InstrumentedStreamBuf(const InstrumentedStreamBuf &) = delete;
+    InstrumentedStreamBuf &operator=(const InstrumentedStreamBuf &) = delete;
+
+protected:
+    int_type underflow() override;
+    int_type uflow() override;
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+    std::streamsize showmanyc() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    std::streambuf &target_;
+
+    /// Position in target_, -1 if it can't tell it
+    off_type position_;
+
+    //----------------------------------------------------------------------------
+    /// Counts a seek that ended at position, if it moved.
+    //
+    pos_type seeked(pos_type position);
+};
+
+//------------------------------------------------------------------------------
+/// Input stream over the buffer of another stream. It reads through an
+/// InstrumentedStreamBuf if IoStats is enabled when it is created, otherwise
+/// directly from the buffer, which keeps reading from memory fast.
+//
+class InstrumentedIStream : public std::istream
+{
+public:
+    explicit InstrumentedIStream(std::streambuf *target);
+
+private:
+    std::unique_ptr<InstrumentedStreamBuf> instrumented_;
+};
+
+} // namespace genie
+
+#endif // GENIE_IOSTATS_H
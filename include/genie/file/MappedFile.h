@@ -0,0 +1,147 @@
+/*
+    Read-only memory mapping of a whole file
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_MAPPEDFILE_H
+#define GENIE_MAPPEDFILE_H
+
+#include <string>
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Read-only memory mapping of a whole file.
+//
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    //----------------------------------------------------------------------------
+    /// Maps the file into memory, closing any previous mapping.
+    ///
+    /// @param fileName file to map
+    /// @exception std::ios_base::failure thrown if the file can't be opened or
+    ///                                   mapped
+    //
+    void open(const std::string &fileName);
+
+    //----------------------------------------------------------------------------
+    /// Unmaps the file. Pointers returned by data() are invalid afterwards.
+    //
+    void close();
+
+    inline bool isOpen() const
+    {
+        return open_;
+    }
+
+    inline const uint8_t *data() const
+    {
+        return data_;
+    }
+
+    inline size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+
+#ifdef _WIN32
+    void *fileHandle_ = nullptr;
+    void *mappingHandle_ = nullptr;
+#endif
+};
+
+//------------------------------------------------------------------------------
+/// Writable memory mapping of a file that is created with it. The mapping
+/// can grow while it is written, closing it cuts the file to the size that
+/// was actually used.
+//
+class WritableMappedFile
+{
+public:
+    WritableMappedFile() = default;
+    ~WritableMappedFile();
+
+    WritableMappedFile(const WritableMappedFile &) = delete;
+    WritableMappedFile &operator=(const WritableMappedFile &) = delete;
+
+    //----------------------------------------------------------------------------
+    /// Creates or truncates the file and maps size bytes of it.
+    ///
+    /// @exception std::ios_base::failure thrown if the file can't be created
+    ///                                   or mapped
+    //
+    void open(const std::string &fileName, size_t size);
+
+    //----------------------------------------------------------------------------
+    /// Grows the file and its mapping. Pointers returned by data() are
+    /// invalid afterwards.
+    ///
+    /// @exception std::ios_base::failure thrown if the file can't be grown
+    //
+    void resize(size_t size);
+
+    //----------------------------------------------------------------------------
+    /// Unmaps the file and cuts it to usedSize bytes.
+    //
+    void close(size_t usedSize);
+
+    inline bool isOpen() const
+    {
+        return open_;
+    }
+
+    inline uint8_t *data() const
+    {
+        return data_;
+    }
+
+    inline size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    void map(void);
+    void unmap(void);
+
+    std::string fileName_;
+    uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+
+#ifdef _WIN32
+    void *fileHandle_ = nullptr;
+    void *mappingHandle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+} // namespace genie
+
+#endif // GENIE_MAPPEDFILE_H
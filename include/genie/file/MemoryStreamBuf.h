@@ -0,0 +1,280 @@
+/*
+    Stream buffer and byte cursor over a block of memory
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_MEMORYSTREAMBUF_H
+#define GENIE_MEMORYSTREAMBUF_H
+
+#include <streambuf>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Read-only stream buffer over a contiguous block of memory that is owned by
+/// someone else (a file mapping, an inflated buffer...).
+///
+/// Besides working as a normal std::streambuf, it exposes a bounds-checked
+/// byte cursor that ISerializable uses to read without going through the
+/// virtual istream machinery. Both share the same read position, so code
+/// that seeks on the istream and code that reads through the cursor can be
+/// mixed freely.
+//
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf() = default;
+    MemoryStreamBuf(const uint8_t *data, size_t size);
+
+    MemoryStreamBuf(const MemoryStreamBuf &) = delete;
+    MemoryStreamBuf &operator=(const MemoryStreamBuf &) = delete;
+
+    //----------------------------------------------------------------------------
+    /// Sets the memory block to read from and rewinds to its start.
+    //
+    void setBuffer(const uint8_t *data, size_t size);
+
+    /// First byte of the buffer
+    inline const uint8_t *begin() const
+    {
+        return reinterpret_cast<const uint8_t *>(eback());
+    }
+
+    /// Current read position
+    inline const uint8_t *current() const
+    {
+        return reinterpret_cast<const uint8_t *>(gptr());
+    }
+
+    /// One past the last byte of the buffer
+    inline const uint8_t *end() const
+    {
+        return reinterpret_cast<const uint8_t *>(egptr());
+    }
+
+    /// Total size of the buffer
+    inline size_t size() const
+    {
+        return egptr() - eback();
+    }
+
+    /// Bytes left to read
+    inline size_t remaining() const
+    {
+        return egptr() - gptr();
+    }
+
+    //----------------------------------------------------------------------------
+    /// Copies size bytes to dest and advances the read position. If less
+    /// bytes are left, the remaining ones are copied like istream::read would.
+    ///
+    /// @return false if there weren't enough bytes left
+    //
+    inline bool take(void *dest, size_t size)
+    {
+        const size_t left = remaining();
+
+        if (size > left) {
+            memcpy(dest, gptr(), left);
+            advance(left);
+            return false;
+        }
+
+        memcpy(dest, gptr(), size);
+        advance(size);
+
+        return true;
+    }
+
+    //----------------------------------------------------------------------------
+    /// Advances the read position.
+    ///
+    /// @return false if there weren't enough bytes left, the position is then
+    ///         moved to the end.
+    //
+    inline bool skip(size_t size)
+    {
+        const size_t left = remaining();
+
+        if (size > left) {
+            advance(left);
+            return false;
+        }
+
+        advance(size);
+        return true;
+    }
+
+protected:
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+    std::streamsize showmanyc() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    /// gbump() only takes an int, which isn't enough for big buffers.
+    inline void advance(size_t size)
+    {
+        setg(eback(), gptr() + size, egptr());
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Write-only stream buffer appending to a vector owned by someone else. The
+/// position can be told, but not changed.
+//
+class VectorStreamBuf : public std::streambuf
+{
+public:
+    explicit VectorStreamBuf(std::vector<uint8_t> &data) :
+        data_(data)
+    {
+    }
+
+    VectorStreamBuf(const VectorStreamBuf &) = delete;
+    VectorStreamBuf &operator=(const VectorStreamBuf &) = delete;
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            data_.push_back(uint8_t(c));
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        data_.insert(data_.end(), s, s + n);
+        return n;
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override
+    {
+        if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) {
+            return pos_type(off_type(-1));
+        }
+
+        return pos_type(off_type(data_.size()));
+    }
+
+private:
+    std::vector<uint8_t> &data_;
+};
+
+//------------------------------------------------------------------------------
+/// Unbuffered stream buffer passing everything on to another one and
+/// counting the bytes read or written through it. Its position can be told
+/// even if the other one can't tell its own, like zstr's, but not changed.
+//
+class CountingStreamBuf : public std::streambuf
+{
+public:
+    explicit CountingStreamBuf(std::streambuf &target) :
+        target_(target)
+    {
+    }
+
+    CountingStreamBuf(const CountingStreamBuf &) = delete;
+    CountingStreamBuf &operator=(const CountingStreamBuf &) = delete;
+
+    /// Bytes read or written so far
+    inline uint64_t count() const
+    {
+        return count_;
+    }
+
+protected:
+    int_type underflow() override
+    {
+        return target_.sgetc();
+    }
+
+    int_type uflow() override
+    {
+        const int_type c = target_.sbumpc();
+
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            count_++;
+        }
+
+        return c;
+    }
+
+    std::streamsize xsgetn(char *s, std::streamsize n) override
+    {
+        const std::streamsize count = target_.sgetn(s, n);
+        count_ += count;
+
+        return count;
+    }
+
+    std::streamsize showmanyc() override
+    {
+        return target_.in_avail();
+    }
+
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+
+        const int_type result = target_.sputc(traits_type::to_char_type(c));
+
+        if (!traits_type::eq_int_type(result, traits_type::eof())) {
+            count_++;
+        }
+
+        return result;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        const std::streamsize count = target_.sputn(s, n);
+        count_ += count;
+
+        return count;
+    }
+
+    int sync() override
+    {
+        return target_.pubsync();
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode /*which*/) override
+    {
+        if (off != 0 || dir != std::ios_base::cur) {
+            return pos_type(off_type(-1));
+        }
+
+        return pos_type(off_type(count_));
+    }
+
+private:
+    std::streambuf &target_;
+    uint64_t count_ = 0;
+};
+} // namespace genie
+
+#endif // GENIE_MEMORYSTREAMBUF_H
@@ -0,0 +1,125 @@
+/*
+    File that is read at explicit offsets
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_POSITIONALFILE_H
+#define GENIE_POSITIONALFILE_H
+
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Read-only file that is read at explicit offsets, with pread() or
+/// ReadFile() with an offset, so it has no position of its own and can be read
+/// from several threads at once.
+//
+class PositionalFile
+{
+public:
+    PositionalFile() = default;
+    ~PositionalFile();
+
+    PositionalFile(const PositionalFile &) = delete;
+    PositionalFile &operator=(const PositionalFile &) = delete;
+
+    //----------------------------------------------------------------------------
+    /// Opens the file, closing any previous one.
+    ///
+    /// @exception std::ios_base::failure thrown if the file can't be opened
+    //
+    void open(const std::string &fileName);
+
+    //----------------------------------------------------------------------------
+    /// Closes the file. It must not be read from any thread while doing so.
+    //
+    void close();
+
+    inline bool isOpen() const
+    {
+        return open_;
+    }
+
+    inline uint64_t size() const
+    {
+        return size_;
+    }
+
+    //----------------------------------------------------------------------------
+    /// Reads up to size bytes at offset. Can be called from several threads at
+    /// once.
+    ///
+    /// @return bytes read, less than size at the end of the file or on errors
+    //
+    size_t readAt(uint64_t offset, void *dest, size_t size) const;
+
+private:
+    uint64_t size_ = 0;
+    bool open_ = false;
+
+#ifdef _WIN32
+    void *fileHandle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+//------------------------------------------------------------------------------
+/// Buffered read-only stream buffer over a PositionalFile, with its own
+/// position. Any number of them can read from the same file in parallel, but
+/// each one only from one thread at a time.
+//
+class PositionalStreamBuf : public std::streambuf
+{
+public:
+    //----------------------------------------------------------------------------
+    /// @param position offset in the file the buffer starts reading at
+    //
+    explicit PositionalStreamBuf(const PositionalFile &file, uint64_t position = 0);
+
+    PositionalStreamBuf(const PositionalStreamBuf &) = delete;
+    PositionalStreamBuf &operator=(const PositionalStreamBuf &) = delete;
+
+protected:
+    int_type underflow() override;
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+    std::streamsize showmanyc() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    const PositionalFile &file_;
+
+    std::vector<char> buffer_;
+
+    /// Offset in the file of the start of the buffer
+    uint64_t bufferOffset_ = 0;
+
+    /// Current offset in the file
+    inline uint64_t position() const
+    {
+        return bufferOffset_ + uint64_t(gptr() - eback());
+    }
+};
+
+} // namespace genie
+
+#endif // GENIE_POSITIONALFILE_H
@@ -20,12 +20,16 @@
 #ifndef GENIE_DRSFILE_H
 #define GENIE_DRSFILE_H
 
+#include <array>
 #include <vector>
 #include <list>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <stdint.h>
 
 #include "genie/file/IFile.h"
+#include "genie/file/PositionalFile.h"
 #include "SlpFile.h"
 #include "BinaFile.h"
 #include "UIFile.h"
@@ -36,6 +40,17 @@ class Logger;
 
 //------------------------------------------------------------------------------
 /// Base class for .drs files
+///
+/// Loaded with LOAD_MAPPED, the archive is mapped once and the resources can
+/// be accessed in place through views, and SLP files decode their frames
+/// from the mapping instead of copying themselves. The views and the SLP
+/// files of a mapped archive are only valid until it is loaded again,
+/// freelock() is called or it is destroyed.
+///
+/// Once loaded, the getters can be called from several threads at once. Each
+/// call reads with its own position, from the mapping or with positional
+/// reads on the file, and the lookup tables don't change anymore. The same
+/// SlpFile is still only to be used from one thread at a time.
 //
 class DrsFile : public IFile
 {
@@ -44,6 +59,31 @@ class DrsFile : public IFile
     static constexpr char slpTableHeader[] = " pls";
 
 public:
+    using IFile::load;
+
+    //----------------------------------------------------------------------------
+    /// Loads the archive, and opens it for positional reads too unless it is
+    /// loaded with LOAD_MAPPED.
+    ///
+    /// @exception std::ios_base::failure thrown if file can't be read
+    //
+    void load(const std::string &fileName) override;
+
+    //----------------------------------------------------------------------------
+    /// Views of the data of a resource in the mapped archive.
+    ///
+    /// @param id resource id
+    /// @return empty if there is no such resource of that type or the archive
+    ///         isn't loaded with LOAD_MAPPED
+    //
+    ByteSpan getSlpView(uint32_t id) const;
+    ByteSpan getWavView(uint32_t id) const;
+    ByteSpan getBinaView(uint32_t id) const;
+
+    //----------------------------------------------------------------------------
+    /// Like getBinaView(), but empty if the bina file isn't a BMP.
+    //
+    ByteSpan getBmpView(uint32_t id) const;
 
     //----------------------------------------------------------------------------
     /// Get a shared pointer to a slp file.
@@ -85,14 +125,70 @@ private:
     std::vector<std::string> table_types_;
     std::vector<uint32_t> table_num_of_files_;
 
+    /// Palettes read so far, guarded by pal_files_mutex_
     std::unordered_map<uint32_t, std::shared_ptr<PalFile>> pal_files_;
+    std::mutex pal_files_mutex_;
+
+    /// Table a resource is in
+    enum EntryType : uint8_t {
+        ENTRY_SLP,
+        ENTRY_BINA,
+        ENTRY_WAV
+    };
+
+    /// Where a resource is in the archive
+    struct Entry {
+        uint32_t id;
+        uint32_t offset;
+        uint32_t size;
+        EntryType type;
+    };
+
+    /// All resources of all tables, sorted by id and type. Nothing is created
+    /// for them until they are requested.
+    std::vector<Entry> entries_;
+
+    /// SLP files requested so far, at the index of their entry. Guarded by
+    /// slp_mutexes_.
+    std::vector<SlpFilePtr> slp_files_;
+
+    /// Read from in parallel if the archive isn't mapped
+    PositionalFile positional_file_;
+
+    /// Guards the stream the archive was read from, if it can be read neither
+    /// from a mapping nor with positional reads
+    std::mutex stream_mutex_;
+
+    /// The SLP files in slp_files_ are read under one of these, picked by id,
+    /// so different files can mostly be read in parallel.
+    std::array<std::mutex, 16> slp_mutexes_;
 
-    std::unordered_map<uint32_t, SlpFilePtr> slp_map_;
-    std::unordered_map<uint32_t, BinaFilePtr> bina_map_;
-    std::unordered_map<uint32_t, uint32_t> wav_offsets_;
+    //----------------------------------------------------------------------------
+    /// Calls function with a stream over the whole archive that no other
+    /// thread reads from, positioned at offset.
+    //
+    template <typename Function>
+    auto withStream(uint32_t offset, Function function) -> decltype(function(std::declval<std::istream *>()));
 
     size_t copyrightHeaderSize() const;
 
+    //----------------------------------------------------------------------------
+    /// Binary search in entries_.
+    ///
+    /// @return nullptr if there is no resource with that id in that table
+    //
+    const Entry *findEntry(uint32_t id, EntryType type) const;
+
+    //----------------------------------------------------------------------------
+    /// View of a resource in the mapped archive.
+    //
+    ByteSpan getView(uint32_t id, EntryType type) const;
+
+    //----------------------------------------------------------------------------
+    /// Bina file to read a resource with.
+    //
+    BinaFile binaFile(const Entry &entry) const;
+
     //----------------------------------------------------------------------------
     /// Loads table and resource headers.
     //
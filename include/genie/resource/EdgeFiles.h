@@ -96,6 +96,8 @@ private:
 
     void serializeObject() override
     {
+        IoStats::Scope ioScope(IoStats::IO_EDGE);
+
         const std::istream::pos_type start = tellg();
 
         serialize(slopeOffsets, SlopeCount);
@@ -0,0 +1,93 @@
+/*
+    Expands palette indexes to RGBA colors
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_PALETTEEXPANDER_H
+#define GENIE_PALETTEEXPANDER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace genie {
+
+class Color;
+struct SmpPixel;
+
+//------------------------------------------------------------------------------
+/// Expands palette indexes to RGBA colors like Color::toUint32(), which is
+/// where baking sprites spends most of its time.
+///
+/// The colors are looked up with AVX2 gathers or SSE4.1 inserts if the CPU
+/// has them, checked once at runtime, otherwise one by one. All kernels give
+/// the same results.
+//
+class PaletteExpander
+{
+public:
+    enum Kernel {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE41,
+        KERNEL_AVX2,
+        KERNEL_COUNT
+    };
+
+    //----------------------------------------------------------------------------
+    /// Looks up count 8-bit indexes in a table of 256 colors.
+    ///
+    /// @param offset added to each index, wrapping around at 256, to get the
+    ///               colors of a player
+    //
+    static void expand(const uint8_t *indexes, size_t count, const uint32_t *colors,
+                       uint32_t *rgba, uint8_t offset = 0);
+
+    //----------------------------------------------------------------------------
+    /// Looks up count SMP/SMX pixels in a table of 1024 colors, the 256 colors
+    /// of each palette section one after another.
+    //
+    static void expand(const SmpPixel *pixels, size_t count, const uint32_t *colors,
+                       uint32_t *rgba);
+
+    //----------------------------------------------------------------------------
+    /// Converts up to size colors to a table for expand(). The rest of the
+    /// table is set to 0, transparent.
+    //
+    static void fillTable(const std::vector<Color> &colors, uint32_t *table, size_t size);
+
+    //----------------------------------------------------------------------------
+    /// The kernel expand() uses, the fastest one the CPU has by default.
+    //
+    static Kernel getKernel(void);
+
+    //----------------------------------------------------------------------------
+    /// Makes expand() use another kernel, for comparing them.
+    ///
+    /// @return false if the CPU doesn't have it, the kernel is not changed then
+    //
+    static bool setKernel(Kernel kernel);
+
+    static bool isSupported(Kernel kernel);
+
+    //----------------------------------------------------------------------------
+    /// Name of a kernel like "avx2".
+    //
+    static const char *getKernelName(Kernel kernel);
+};
+
+} // namespace genie
+
+#endif // GENIE_PALETTEEXPANDER_H
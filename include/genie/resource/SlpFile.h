@@ -32,10 +32,17 @@
 
 namespace genie {
 
+class ThreadPool;
+
 //------------------------------------------------------------------------------
 /// A slp file stores one or several images encoded using simple commands.
 /// The image is stored as 8 bits per pixel, that means only the index of a
 /// color in a palette is saved.
+///
+/// The frames are decoded from a copy of the file, unless it is read from
+/// memory with LOAD_MAPPED set. They are then decoded from that memory,
+/// which needs to stay valid, like a mapped file or the mapping of a DRS
+/// archive.
 //
 class SlpFile : public IFile
 {
@@ -47,7 +54,8 @@ public:
     SlpFile(const size_t size);
 
     //----------------------------------------------------------------------------
-    /// Frees all content of a slp file.
+    /// Frees the frames. The data of the file is kept, the frames are loaded
+    /// from it again when they are needed.
     //
     void unload() override;
 
@@ -74,12 +82,38 @@ public:
 
     void setFrame(uint32_t, SlpFramePtr);
 
+    //----------------------------------------------------------------------------
+    /// Decodes all frames that aren't decoded yet at once, one task per frame
+    /// on pool and the calling thread. The frames are independent, so they
+    /// are the same as decoded by getFrame(). The file must not be used
+    /// otherwise until it returns.
+    ///
+    /// @exception rethrows the first exception of the frames, after all of
+    ///            them are done
+    //
+    void decodeAllFrames(ThreadPool &pool);
+
+    //----------------------------------------------------------------------------
+    /// Decodes a frame straight to RGBA, see SlpFrame::decodeRgba(). The
+    /// frame's own image data isn't decoded for that.
+    ///
+    /// @param pixels frameWidth(frame) * frameHeight(frame) pixels with the given stride
+    /// @return false if the frame is broken
+    //
+    bool decodeFrameRgba(uint32_t frame, const PalFile &palette, uint8_t player,
+                         uint32_t *pixels, size_t stride,
+                         const SlpRgbaColors &colors = SlpRgbaColors());
+
     /// For normal SLPs, e. g. '2.0N', for new SMP from Aoe2:DE 'SMP$'
     std::string version;
 
     std::string comment;
 
-    const std::vector<uint8_t> &fileData() const { return m_graphicsFileData; }
+    //----------------------------------------------------------------------------
+    /// The whole file, in memory owned by this file or the memory it was
+    /// read from. Available after load.
+    //
+    ByteSpan fileData() const { return data_; }
 
     int frameCommandsOffset(const size_t frame, const int row);
     int frameHeight(const size_t frame);
@@ -87,6 +121,7 @@ public:
 
 private:
     friend class SlpTemplateFile;
+    friend class DrsFile;
 
     static Logger &log;
 
@@ -101,6 +136,11 @@ private:
     // Used to calculate offsets when saving the SLP.
     uint32_t slp_offset_;
 
+    //----------------------------------------------------------------------------
+    /// Whether the image of frame is read, 32 bit frames only have BGRA.
+    //
+    static bool isDecoded(const SlpFrame &frame);
+
     //----------------------------------------------------------------------------
     void serializeObject() override;
 
@@ -110,10 +150,25 @@ private:
     void loadFile();
     void saveFile();
 
+    //----------------------------------------------------------------------------
+    /// Reads the headers and frames from data_.
+    //
+    void loadFromData();
+
+    //----------------------------------------------------------------------------
+    /// Loads the file again after unload(), from the data it kept.
+    ///
+    /// @exception std::logic_error thrown if the file was never loaded
+    //
+    void reload();
+
     //----------------------------------------------------------------------------
     void serializeHeader();
 
     std::vector<uint8_t> m_graphicsFileData;
+
+    /// m_graphicsFileData or the memory the file was read from
+    ByteSpan data_;
 };
 
 typedef std::shared_ptr<SlpFile> SlpFilePtr;
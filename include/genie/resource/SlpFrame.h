@@ -20,11 +20,14 @@
 #ifndef GENIE_SLPFRAME_H
 #define GENIE_SLPFRAME_H
 
+#include "genie/file/ByteSpan.h"
 #include "genie/file/ISerializable.h"
 #include "genie/resource/SlpTemplate.h"
 #include "genie/util/Logger.h"
 
 #include <istream>
+#include <iterator>
+#include <type_traits>
 #include <vector>
 #include <set>
 #include <stdint.h>
@@ -63,21 +66,278 @@ inline bool operator<(const PlayerColorXY &l, const PlayerColorXY &r)
 {
     return l.y == r.y ? l.x < r.x : l.y < r.y;
 }
+
+//------------------------------------------------------------------------------
+/// Pixels of a frame stored as runs in rows, in the order they were added. A
+/// pixel right after the last run extends it, so a run of shadow takes as
+/// much memory as one of its pixels. Iterating it gives the single pixels.
+///
+/// Pixel is XY, or PlayerColorXY which also keeps the palette index of each
+/// pixel.
+//
+template <typename Pixel>
+class SlpPixelMask
+{
+    static constexpr bool hasIndexes = std::is_same<Pixel, PlayerColorXY>::value;
+
+public:
+    /// Run of count pixels in row y, from column x on
+    struct Span {
+        uint32_t x;
+        uint32_t y;
+        uint32_t count;
+    };
+
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Pixel value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Pixel *pointer;
+        typedef const Pixel &reference;
+
+        const_iterator() = default;
+
+        const_iterator(const Span *span, const Span *end, const uint8_t *index) :
+            span_(span),
+            end_(end),
+            index_(index)
+        {
+            load();
+        }
+
+        inline const Pixel &operator*() const
+        {
+            return pixel_;
+        }
+
+        inline const Pixel *operator->() const
+        {
+            return &pixel_;
+        }
+
+        inline const_iterator &operator++()
+        {
+            if (++offset_ == span_->count) {
+                ++span_;
+                offset_ = 0;
+            }
+
+            if constexpr (hasIndexes) {
+                ++index_;
+            }
+
+            load();
+            return *this;
+        }
+
+        inline const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        inline bool operator==(const const_iterator &other) const
+        {
+            return span_ == other.span_ && offset_ == other.offset_;
+        }
+
+        inline bool operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const Span *span_ = nullptr;
+        const Span *end_ = nullptr;
+        const uint8_t *index_ = nullptr;
+        uint32_t offset_ = 0;
+        Pixel pixel_{};
+
+        inline void load()
+        {
+            if (span_ == end_) {
+                return;
+            }
+
+            pixel_.x = span_->x + offset_;
+            pixel_.y = span_->y;
+
+            if constexpr (hasIndexes) {
+                pixel_.index = *index_;
+            }
+        }
+    };
+
+    typedef const_iterator iterator;
+
+    SlpPixelMask() = default;
+
+    template <typename Iterator>
+    SlpPixelMask(Iterator first, Iterator last)
+    {
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    inline void push_back(const Pixel &pixel)
+    {
+        if constexpr (hasIndexes) {
+            append(pixel.x, pixel.y, 1, &pixel.index);
+        } else {
+            append(pixel.x, pixel.y, 1);
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    /// Adds count pixels of row y from column x on.
+    //
+    inline void append(uint32_t x, uint32_t y, uint32_t count)
+    {
+        static_assert(!hasIndexes, "player color pixels need their indexes");
+        appendSpan(x, y, count);
+    }
+
+    //----------------------------------------------------------------------------
+    /// Adds count player color pixels of row y from column x on, with their
+    /// palette indexes.
+    //
+    inline void append(uint32_t x, uint32_t y, uint32_t count, const uint8_t *indexes)
+    {
+        static_assert(hasIndexes, "only player color pixels have indexes");
+
+        if (appendSpan(x, y, count)) {
+            indexes_.insert(indexes_.end(), indexes, indexes + count);
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    /// Adds count player color pixels of row y from column x on, all with the
+    /// same palette index.
+    //
+    inline void fill(uint32_t x, uint32_t y, uint32_t count, uint8_t index)
+    {
+        static_assert(hasIndexes, "only player color pixels have indexes");
+
+        if (appendSpan(x, y, count)) {
+            indexes_.resize(indexes_.size() + count, index);
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    /// Moves all pixels.
+    //
+    inline void offset(int32_t x, int32_t y)
+    {
+        for (Span &span : spans_) {
+            span.x += x;
+            span.y += y;
+        }
+    }
+
+    inline void clear()
+    {
+        spans_.clear();
+        indexes_.clear();
+        size_ = 0;
+    }
+
+    /// Number of pixels
+    inline size_t size() const
+    {
+        return size_;
+    }
+
+    inline bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    inline const std::vector<Span> &spans() const
+    {
+        return spans_;
+    }
+
+    /// Palette indexes of all player color pixels, in the order of the spans
+    inline const std::vector<uint8_t> &indexes() const
+    {
+        return indexes_;
+    }
+
+    inline const_iterator begin() const
+    {
+        return const_iterator(spans_.data(), spans_.data() + spans_.size(), indexes_.data());
+    }
+
+    inline const_iterator end() const
+    {
+        const Span *end = spans_.data() + spans_.size();
+        return const_iterator(end, end, nullptr);
+    }
+
+private:
+    std::vector<Span> spans_;
+    std::vector<uint8_t> indexes_;
+    size_t size_ = 0;
+
+    //----------------------------------------------------------------------------
+    /// @return false if there are no pixels to add
+    //
+    inline bool appendSpan(uint32_t x, uint32_t y, uint32_t count)
+    {
+        if (count == 0) {
+            return false;
+        }
+
+        size_ += count;
+
+        if (!spans_.empty()) {
+            Span &last = spans_.back();
+
+            if (last.y == y && last.x + last.count == x) {
+                last.count += count;
+                return true;
+            }
+        }
+
+        spans_.push_back({ x, y, count });
+        return true;
+    }
+};
+
 struct SlpFrameData {
 
     std::vector<uint8_t> pixel_indexes;
     std::vector<uint32_t> bgra_channels;
     std::vector<uint8_t> alpha_channel;
 
-    std::vector<XY> shadow_mask;
-    std::vector<XY> shield_mask;
-    std::vector<XY> outline_pc_mask;
-    std::vector<XY> transparency_mask;
+    SlpPixelMask<XY> shadow_mask;
+    SlpPixelMask<XY> shield_mask;
+    SlpPixelMask<XY> outline_pc_mask;
+    SlpPixelMask<XY> transparency_mask;
 
-    std::vector<PlayerColorXY> player_color_mask;
+    SlpPixelMask<PlayerColorXY> player_color_mask;
     std::vector<genie::Color> palette;
 };
 
+//------------------------------------------------------------------------------
+/// Colors SlpFrame::decodeRgba() draws the pixels that don't have a palette
+/// color with, as RGBA like Color::toUint32(). 0 leaves them transparent.
+//
+struct SlpRgbaColors {
+    /// Half transparent black
+    uint32_t shadow = 0x80000000;
+
+    /// Outline in player color, shown where a unit is behind something
+    uint32_t outline_pc = 0;
+
+    /// Outline shown where a unit is behind something
+    uint32_t shield = 0;
+};
+
 //------------------------------------------------------------------------------
 /// Class for reading a frame of a slp file. Once loaded the image can be
 /// obtained as a pixel array. A pixel is stored as the index of a color
@@ -131,13 +391,17 @@ public:
     //
     void serializeHeader(void);
     void setLoadParams(std::istream &istr);
+
+    /// Forgets the stream of setLoadParams() once the header is read.
+    void clearLoadParams(void);
+
     void setSaveParams(std::ostream &ostr, uint32_t &slp_offset_);
 
     //----------------------------------------------------------------------------
-    /// Loads frame data and creates an image. Frame data is located after all
-    /// frame headers of the slp file.
+    /// Loads the edges, command offsets and embedded palette of the frame
+    /// from the slp file, which starts at the slp file position in data.
     //
-    void load(std::istream &istr);
+    void load(ByteSpan data);
     void save(std::ostream &ostr);
 
     //----------------------------------------------------------------------------
@@ -196,7 +460,32 @@ public:
 
     std::shared_ptr<SlpFrame> mirrorX(void);
 
-    void readImage();
+    //----------------------------------------------------------------------------
+    /// Decodes the image from the commands in the slp file, after load(). The
+    /// commands are parsed directly from file, which is the same as given
+    /// to load().
+    //
+    void readImage(ByteSpan file);
+
+    //----------------------------------------------------------------------------
+    /// Decodes the image straight to RGBA in one pass, without filling
+    /// img_data. All pixels of the frame are written, transparent ones as 0.
+    /// Can be called after load().
+    ///
+    /// @param file slp file as given to load()
+    /// @param palette colors of the pixel indexes, a frame with an embedded
+    ///                palette uses that instead
+    /// @param player player color pixels get palette index 16 * player plus
+    ///               their index
+    /// @param pixels width * height pixels, RGBA like Color::toUint32()
+    /// @param stride pixels from the start of one row to the next
+    /// @param colors colors of shadows and outlines
+    /// @return false if the frame is broken, it is transparent from where
+    ///         decoding stopped
+    //
+    bool decodeRgba(ByteSpan file, const PalFile &palette, uint8_t player,
+                    uint32_t *pixels, size_t stride,
+                    const SlpRgbaColors &colors = SlpRgbaColors()) const;
 
     uint32_t commandsOffset(const int row)
     {
@@ -227,33 +516,32 @@ private:
     void serializeObject(void) override;
 
     //----------------------------------------------------------------------------
-    /// Reads pixel indexes from file and sets the pixels according to the
-    /// colors from the palette.
-    /// It is assumed that the stream pointer is at the start of the pixel array.
+    /// Copies pixel indexes to the image and makes them opaque.
     ///
     /// @param row row to set pixels at
     /// @param col column to set pixels from
-    /// @param count how many pixels should be read
+    /// @param count how many pixels should be copied
+    /// @param pixels count pixel indexes
     /// @param player_col if true, pixel will be written to player color image
     //
     void readPixelsToImage(uint32_t row, uint32_t &col, uint32_t count,
-                           bool player_col = false);
+                           const uint8_t *pixels, bool player_col = false);
     void readPixelsToImage32(uint32_t row, uint32_t &col, uint32_t count,
-                             uint8_t special = 0);
+                             const uint8_t *pixels, uint8_t special = 0);
 
     //----------------------------------------------------------------------------
-    /// Sets the next count of pixels to given color without reading from stream.
+    /// Sets the next count of pixels to given color.
     ///
     /// @param row row to set pixels at
     /// @param col column to set pixels from
     /// @param count how many pixels should be set
-    /// @param color color to set
+    /// @param color_index color to set, bgra for 32 bit frames
     /// @param player_col if true, pixel will be written to player color image
     //
     void setPixelsToColor(uint32_t row, uint32_t &col, uint32_t count,
-                          bool player_col = false);
+                          uint8_t color_index, bool player_col = false);
     void setPixelsToColor32(uint32_t row, uint32_t &col, uint32_t count,
-                            bool player_col = false);
+                            uint32_t bgra, bool player_col = false);
 
     //----------------------------------------------------------------------------
     /// Sets the next count of pixels to shadow without reading from stream.
@@ -263,11 +551,26 @@ private:
 
     //----------------------------------------------------------------------------
     /// This method returns either the count stored in command byte or (if not
-    /// stored in command) the value of the next byte.
+    /// stored in command) the value of the next byte, which pos is moved past.
     ///
     /// @param data command byte
+    /// @param pos next byte after the command
+    /// @param end end of the file, 0 is returned instead of reading past it
     //
-    uint8_t getPixelCountFromData(uint8_t data);
+    static uint8_t getPixelCountFromData(uint8_t data, const uint8_t *&pos, const uint8_t *end);
+
+    //----------------------------------------------------------------------------
+    /// Parses the commands of all rows in file and passes the pixels on to
+    /// target, an ImageTarget or RgbaTarget.
+    ///
+    /// @param pixelsRead incremented by the pixels of all commands
+    /// @return false if the commands are broken
+    //
+    template <typename Target>
+    bool decodeCommands(ByteSpan file, Target &target, size_t &pixelsRead) const;
+
+    struct ImageTarget;
+    struct RgbaTarget;
 
     enum cnt_type { CNT_LEFT,
                     CNT_SAME,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SmpFrame.h"
+#include "PalFile.h"
 
 #include "genie/file/ISerializable.h"
 #include "genie/util/Logger.h"
@@ -46,6 +47,13 @@ public:
         return m_pixels[pixelIndex].section * 256 + m_pixels[pixelIndex].index;
     }
 
+    /// Writes the visible pixels of the normal layer as RGBA, see
+    /// PaletteExpander, and the rest as 0.
+    /// @param palette the 1024 colors of all palette sections
+    /// @param pixels width() * height() pixels
+    /// @param stride pixels from the start of one row to the next
+    void decodeRgba(const PalFile &palette, uint32_t *pixels, size_t stride) const;
+
 protected:
     void serializeObject() override;
 
@@ -60,13 +68,13 @@ private:
         uint32_t size = 0; /// Length of frame in bytes
         uint32_t unknown = 0;
 
-        struct RowEdge : public ISerializable {
+        struct RowEdge {
             uint16_t padLeft = 0;
             uint16_t padRight = 0;
 
-            void serializeObject() override {
-                serialize(padLeft);
-                serialize(padRight);
+            void serializeFields(RecordArchive &archive) {
+                archive(padLeft);
+                archive(padRight);
             }
         };
         /// Directly after the layer header, an array of smp_layer_row_edge (of length height) structs begins. These work exactly like the row edges in the SMP files.
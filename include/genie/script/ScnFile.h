@@ -26,6 +26,7 @@
 
 #include "genie/file/IFile.h"
 #include "genie/file/Compressor.h"
+#include "genie/util/ThreadPool.h"
 
 #include "scn/ScnPlayerData.h"
 #include "scn/MapDescription.h"
@@ -86,9 +87,34 @@ public:
     ScnFile();
 
     //----------------------------------------------------------------------------
-    /// Extracts a scenario (for debugging purpose).
+    /// Extracts a scenario (for debugging purpose). The uncompressed header
+    /// is copied, followed by the inflated rest of the file.
+    ///
+    /// @exception std::ios_base::failure thrown if from can't be read or
+    ///                                   inflated, or to can't be written
     //
-    void extractRaw(const char *from, const char *to);
+    void extractRaw(const char *from, const char *to,
+                    const DecompressOptions &options = DecompressOptions());
+
+    //----------------------------------------------------------------------------
+    /// Sets the number of threads used for compressing when saving, including
+    /// the calling one, see Compressor::setThreadPool().
+    ///
+    /// @param threadCount number of threads, 0 uses one per hardware thread
+    //
+    void setThreadCount(size_t threadCount);
+
+    //----------------------------------------------------------------------------
+    size_t getThreadCount(void) const;
+
+    //----------------------------------------------------------------------------
+    /// Sets the zlib compression level used for saving, from 0 (stored) to 9
+    /// (smallest). -1, the default, is zlib's default level 6.
+    //
+    void setCompressionLevel(int level);
+
+    //----------------------------------------------------------------------------
+    int getCompressionLevel(void) const;
 
     static uint32_t getSeparator(void);
 
@@ -143,6 +169,9 @@ private:
 
     Compressor compressor_;
 
+    size_t threadCount_ = 1;
+    std::unique_ptr<ThreadPool> threadPool_;
+
     void serializeObject(void) override;
 
     void serializeVersion(void);
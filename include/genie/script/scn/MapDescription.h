@@ -27,7 +27,7 @@
 
 namespace genie {
 
-class MapTile : public ISerializable
+class MapTile
 {
 public:
     uint8_t terrainID = 0;
@@ -36,8 +36,12 @@ public:
     /// always 0
     uint8_t unused = 0;
 
-private:
-    void serializeObject(void) override;
+    void serializeFields(RecordArchive &archive)
+    {
+        archive(terrainID);
+        archive(elevation);
+        archive(unused);
+    }
 };
 
 /// Naming it ScnMap because it may be used elsewhere
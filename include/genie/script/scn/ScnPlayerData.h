@@ -44,8 +44,6 @@ public:
     uint32_t ore;
     uint32_t goods;
 
-    static bool playerInfo;
-
 private:
     void serializeObject(void) override;
 };
@@ -0,0 +1,42 @@
+/*
+    Counts heap allocations per thread
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_ALLOCATIONCOUNTER_H
+#define GENIE_ALLOCATIONCOUNTER_H
+
+#include <stdint.h>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Number of heap allocations the calling thread made with operator new so
+/// far. Allocations are only counted if the library is built with
+/// GUTILS_COUNT_ALLOCATIONS, which replaces the global operator new and
+/// delete of the whole program. Otherwise this is always 0, check
+/// isCountingAllocations() before using it.
+//
+uint64_t getAllocationCount(void);
+
+//------------------------------------------------------------------------------
+/// Whether the library is built to count allocations.
+//
+bool isCountingAllocations(void);
+
+} // namespace genie
+
+#endif // GENIE_ALLOCATIONCOUNTER_H
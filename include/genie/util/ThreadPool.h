@@ -0,0 +1,98 @@
+/*
+    Fixed set of worker threads running queued tasks
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_THREADPOOL_H
+#define GENIE_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+/// Fixed set of worker threads running queued tasks in submission order.
+//
+class ThreadPool
+{
+public:
+    //----------------------------------------------------------------------------
+    /// Starts the worker threads.
+    ///
+    /// @param threadCount number of workers, 0 uses one per hardware thread
+    //
+    explicit ThreadPool(size_t threadCount = 0);
+
+    //----------------------------------------------------------------------------
+    /// Runs the tasks that are still queued and joins the workers.
+    //
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    inline size_t threadCount(void) const
+    {
+        return workers_.size();
+    }
+
+    //----------------------------------------------------------------------------
+    /// Queues a task. Exceptions thrown by it are rethrown by the returned
+    /// future's get().
+    //
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F &&task)
+    {
+        using Result = std::invoke_result_t<F>;
+
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+
+        push([packaged]() { (*packaged)(); });
+
+        return result;
+    }
+
+    //----------------------------------------------------------------------------
+    /// Runs one queued task on the calling thread, if there is one. Lets a
+    /// thread waiting for results help out instead of blocking.
+    ///
+    /// @return false if the queue was empty
+    //
+    bool runPendingTask(void);
+
+private:
+    void push(std::function<void()> task);
+    void work(void);
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+    bool stopping_ = false;
+};
+} // namespace genie
+
+#endif // GENIE_THREADPOOL_H
@@ -35,6 +35,12 @@ unsigned short Civ::getNameSize(void)
 }
 
 void Civ::serializeObject(void)
+{
+    const uint16_t count = serializeHeader();
+    serializeSubWithPointers<Unit>(Units, count, UnitPointers);
+}
+
+uint16_t Civ::serializeHeader(void)
 {
     GameVersion gv = getGameVersion();
 
@@ -68,6 +74,7 @@ void Civ::serializeObject(void)
 
     serializeSize<uint16_t>(count, Units.size());
     serialize<int32_t>(UnitPointers, count);
-    serializeSubWithPointers<Unit>(Units, count, UnitPointers);
+
+    return count;
 }
 } // namespace genie
@@ -22,14 +22,177 @@
 
 #include <fstream>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+
+#include <zlib.h>
 
 #include "genie/Types.h"
+#include "genie/util/AllocationCounter.h"
 
 namespace genie {
 
-float ISerializable::dat_internal_ver = 0.f;
 GameVersion GV_LatestTap = GV_T8;
 
+namespace {
+
+/// Amount of data read by one task when loading with multiple threads.
+constexpr size_t PARALLEL_CHUNK_SIZE = 32 * 1024;
+
+/// Start of every snapshot file
+constexpr char SNAPSHOT_MAGIC[8] = { 'G', 'E', 'N', 'I', 'E', 'S', 'N', 'P' };
+
+/// Changed whenever the layout of snapshots or their ranges change.
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+/// Magic, version, game version, source size and checksum, range count and
+/// data size
+constexpr size_t SNAPSHOT_HEADER_SIZE = 8 + 4 + 4 + 8 + 4 + 4 + 8;
+constexpr size_t SNAPSHOT_RANGE_SIZE = 4 + 4 + 4 + 8 + 8;
+
+//------------------------------------------------------------------------------
+template <typename T>
+void putValue(std::vector<uint8_t> &data, T value)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+T getValue(const uint8_t *&data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+
+    return value;
+}
+
+//------------------------------------------------------------------------------
+uint32_t checksum(const uint8_t *data, size_t size)
+{
+    uLong crc = crc32(0, Z_NULL, 0);
+
+    // The length is only an uInt.
+    while (size > 0) {
+        const uInt length = uInt(std::min<size_t>(size, 1 << 30));
+        crc = crc32(crc, data, length);
+        data += length;
+        size -= length;
+    }
+
+    return uint32_t(crc);
+}
+
+//------------------------------------------------------------------------------
+/// Reads a range of objects with its own cursor into the decompressed data,
+/// so ranges can be read later or at the same time.
+//
+template <typename T>
+class ObjectRangeReader : public ISerializable
+{
+public:
+    ObjectRangeReader(SerializationContext &rootContext, T *objects,
+                      const int32_t *pointers, size_t count) :
+        rootContext_(&rootContext),
+        objects_(objects),
+        pointers_(pointers),
+        count_(count)
+    {
+    }
+
+    void read(const uint8_t *data, size_t size, size_t offset, GameVersion gv)
+    {
+        MemoryStreamBuf buffer(data, size);
+        std::istream stream(&buffer);
+
+        setGameVersion(gv);
+        setInitialReadPosition(offset);
+        readObject(stream);
+    }
+
+private:
+    SerializationContext *rootContext_;
+    T *objects_;
+    const int32_t *pointers_;
+    size_t count_;
+
+    SerializationContext *ownContext(void) override
+    {
+        return rootContext_;
+    }
+
+    void serializeObject(void) override
+    {
+        for (size_t i = 0; i < count_; ++i) {
+            if (!pointers_ || pointers_[i]) {
+                serializeSub(objects_[i]);
+            }
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Reads a civilization and passes it and its units to a visitor, reading
+/// the units one by one into the same object.
+//
+class CivStreamer : public Civ
+{
+public:
+    explicit CivStreamer(DatFile::Visitor &visitor) :
+        visitor_(visitor)
+    {
+    }
+
+    size_t index = 0;
+
+private:
+    DatFile::Visitor &visitor_;
+    Unit unit_;
+
+    void serializeObject(void) override
+    {
+        const uint16_t count = serializeHeader();
+        visitor_.visitCiv(index, *this);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (UnitPointers[i]) {
+                // Parts a unit type doesn't have aren't read, so they must
+                // not be left over from the previous unit.
+                unit_ = Unit();
+                serializeSub(unit_);
+                visitor_.visitUnit(index, i, unit_);
+            }
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+void visitObject(DatFile::Visitor &visitor, size_t index, const Effect &effect)
+{
+    visitor.visitEffect(index, effect);
+}
+
+//------------------------------------------------------------------------------
+void visitObject(DatFile::Visitor &visitor, size_t index, const Tech &tech)
+{
+    visitor.visitTech(index, tech);
+}
+
+//------------------------------------------------------------------------------
+/// Objects the visitor doesn't receive are only skipped.
+//
+template <typename T>
+void visitObject(DatFile::Visitor &, size_t, const T &)
+{
+}
+} // namespace
+
 //------------------------------------------------------------------------------
 DatFile::DatFile() :
     compressor_(this)
@@ -56,18 +219,16 @@ void DatFile::setGameVersion(GameVersion gv)
 }
 
 //------------------------------------------------------------------------------
-void DatFile::extractRaw(const char *inFile, const char *outFile)
+void DatFile::extractRaw(const char *inFile, const char *outFile,
+                         const DecompressOptions &options)
 {
-    std::ifstream ifs;
-    std::ofstream ofs;
-
-    ifs.open(inFile, std::ios::binary);
-    ofs.open(outFile, std::ios::binary);
+    std::ifstream ifs(inFile, std::ios::binary);
 
-    Compressor::decompress(ifs, ofs);
+    if (ifs.fail()) {
+        throw std::ios_base::failure("Can't read file \"" + std::string(inFile) + "\"");
+    }
 
-    ifs.close();
-    ofs.close();
+    Compressor::decompress(ifs, outFile, options);
 }
 
 //------------------------------------------------------------------------------
@@ -76,11 +237,976 @@ void DatFile::setVerboseMode(bool verbose)
     verbose_ = verbose;
 }
 
+//------------------------------------------------------------------------------
+void DatFile::setThreadCount(size_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    threadCount_ = threadCount;
+}
+
+//------------------------------------------------------------------------------
+size_t DatFile::getThreadCount(void) const
+{
+    return threadCount_;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::setCompressionLevel(int level)
+{
+    compressor_.setCompressionLevel(level);
+}
+
+//------------------------------------------------------------------------------
+int DatFile::getCompressionLevel(void) const
+{
+    return compressor_.getCompressionLevel();
+}
+
+//------------------------------------------------------------------------------
+void DatFile::setDecompressToMemory(bool inMemory)
+{
+    decompressToMemory_ = inMemory;
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::isDecompressingToMemory(void) const
+{
+    return decompressToMemory_;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::setLazyLoading(bool lazy)
+{
+    lazyLoading_ = lazy;
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::isLazyLoading(void) const
+{
+    return lazyLoading_;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::setIncrementalSaving(bool incremental)
+{
+    incrementalSaving_ = incremental;
+
+    if (!incremental) {
+        sectionCache_ = SectionCache();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::isIncrementalSaving(void) const
+{
+    return incrementalSaving_;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::invalidateSection(Section section)
+{
+    sectionCache_.sections[section].valid = false;
+
+    if (section == SECTION_CIVS) {
+        sectionCache_.civs.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void DatFile::invalidateCiv(size_t index)
+{
+    sectionCache_.sections[SECTION_CIVS].valid = false;
+
+    if (index < sectionCache_.civs.size()) {
+        sectionCache_.civs[index].valid = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::isSectionLoaded(Section section) const
+{
+    for (const LazyRead &read : lazyReads_[section]) {
+        if (read.read) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::loadSection(Section section)
+{
+    if (lazyReads_[section].empty()) {
+        return;
+    }
+
+    for (LazyRead &read : lazyReads_[section]) {
+        if (read.read) {
+            read.read();
+        }
+    }
+
+    lazyReads_[section].clear();
+    releaseLazyData();
+}
+
+//------------------------------------------------------------------------------
+void DatFile::loadAllSections(void)
+{
+    if (threadCount_ > 1) {
+        ThreadPool &pool = threadPool();
+
+        for (std::vector<LazyRead> &reads : lazyReads_) {
+            for (LazyRead &read : reads) {
+                if (read.read) {
+                    pendingReads_.push_back(pool.submit(std::move(read.read)));
+                }
+            }
+
+            reads.clear();
+        }
+
+        std::exception_ptr error = waitForReads();
+        releaseLazyData();
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        return;
+    }
+
+    for (size_t section = 0; section < SECTION_COUNT; ++section) {
+        loadSection(Section(section));
+    }
+}
+
+//------------------------------------------------------------------------------
+Civ &DatFile::getCiv(size_t index)
+{
+    for (LazyRead &read : lazyReads_[SECTION_CIVS]) {
+        if (read.read && index >= read.first && index < read.first + read.count) {
+            read.read();
+            read.read = nullptr;
+            break;
+        }
+    }
+
+    Civ &civ = Civs.at(index);
+    releaseLazyData();
+
+    return civ;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::stream(const std::string &fileName, Visitor &visitor)
+{
+    visitor_ = &visitor;
+
+    try {
+        load(fileName);
+    } catch (...) {
+        visitor_ = nullptr;
+        unload();
+        throw;
+    }
+
+    visitor_ = nullptr;
+    unload();
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::loadWithSnapshot(const std::string &fileName, const std::string &snapshotFileName)
+{
+    SnapshotKey key;
+
+    {
+        MappedFile source;
+        source.open(fileName);
+
+        key.sourceSize = source.size();
+        key.sourceCrc = checksum(source.data(), source.size());
+        key.gameVersion = uint32_t(getGameVersion());
+    }
+
+    // The objects are located first and read at the end, from either file.
+    const bool lazy = lazyLoading_;
+    lazyLoading_ = true;
+
+    bool upToDate = false;
+
+    try {
+        upToDate = loadSnapshot(snapshotFileName, key);
+
+        if (upToDate) {
+            freelock();
+            setFileName(fileName);
+        } else {
+            snapshotRanges_.clear();
+            snapshotState_ = SNAPSHOT_RECORD;
+            load(fileName);
+            snapshotState_ = SNAPSHOT_NONE;
+
+            writeSnapshot(snapshotFileName, key);
+        }
+    } catch (...) {
+        lazyLoading_ = lazy;
+        snapshotState_ = SNAPSHOT_NONE;
+        snapshotRanges_.clear();
+        throw;
+    }
+
+    lazyLoading_ = lazy;
+    std::vector<SnapshotRange>().swap(snapshotRanges_);
+
+    if (!lazyLoading_) {
+        loadAllSections();
+    }
+
+    releaseLazyData();
+
+    return upToDate;
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::loadSnapshot(const std::string &snapshotFileName, const SnapshotKey &key)
+{
+    std::unique_ptr<MappedFile> snapshot = std::make_unique<MappedFile>();
+
+    try {
+        snapshot->open(snapshotFileName);
+    } catch (const std::ios_base::failure &) {
+        return false;
+    }
+
+    const uint8_t *pos = snapshot->data();
+    const uint8_t *end = pos + snapshot->size();
+
+    if (snapshot->size() < SNAPSHOT_HEADER_SIZE ||
+        memcmp(pos, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC) != 0) {
+        return false;
+    }
+
+    pos += sizeof SNAPSHOT_MAGIC;
+
+    const uint32_t version = getValue<uint32_t>(pos);
+    const uint32_t gameVersion = getValue<uint32_t>(pos);
+    const uint64_t sourceSize = getValue<uint64_t>(pos);
+    const uint32_t sourceCrc = getValue<uint32_t>(pos);
+    const uint32_t rangeCount = getValue<uint32_t>(pos);
+    const uint64_t dataSize = getValue<uint64_t>(pos);
+
+    if (version != SNAPSHOT_VERSION || gameVersion != key.gameVersion ||
+        sourceSize != key.sourceSize || sourceCrc != key.sourceCrc ||
+        uint64_t(end - pos) != uint64_t(rangeCount) * SNAPSHOT_RANGE_SIZE + dataSize) {
+        return false;
+    }
+
+    snapshotRanges_.resize(rangeCount);
+
+    for (SnapshotRange &range : snapshotRanges_) {
+        range.section = getValue<uint32_t>(pos);
+        range.first = getValue<uint32_t>(pos);
+        range.count = getValue<uint32_t>(pos);
+        range.offset = getValue<uint64_t>(pos);
+        range.size = getValue<uint64_t>(pos);
+    }
+
+    MemoryStreamBuf buffer(pos, dataSize);
+    std::istream stream(&buffer);
+
+    snapshotState_ = SNAPSHOT_REPLAY;
+    nextSnapshotRange_ = 0;
+
+    bool replayed = true;
+
+    try {
+        readObject(stream);
+    } catch (const std::exception &error) {
+        std::cerr << "Ignoring snapshot \"" << snapshotFileName << "\": "
+                  << error.what() << std::endl;
+        replayed = false;
+    }
+
+    // The stream ends with this function, the lazy reads don't use it.
+    clearIStream();
+    snapshotState_ = SNAPSHOT_NONE;
+
+    if (!replayed) {
+        return false;
+    }
+
+    // Kept until all sections are loaded.
+    snapshotData_ = std::move(snapshot);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::writeSnapshot(const std::string &snapshotFileName, const SnapshotKey &key)
+{
+    std::vector<uint8_t> header;
+    header.reserve(SNAPSHOT_HEADER_SIZE + snapshotRanges_.size() * SNAPSHOT_RANGE_SIZE);
+
+    header.insert(header.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof SNAPSHOT_MAGIC);
+    putValue<uint32_t>(header, SNAPSHOT_VERSION);
+    putValue<uint32_t>(header, key.gameVersion);
+    putValue<uint64_t>(header, key.sourceSize);
+    putValue<uint32_t>(header, key.sourceCrc);
+    putValue<uint32_t>(header, snapshotRanges_.size());
+    putValue<uint64_t>(header, lazyData_.size());
+
+    for (const SnapshotRange &range : snapshotRanges_) {
+        putValue<uint32_t>(header, range.section);
+        putValue<uint32_t>(header, range.first);
+        putValue<uint32_t>(header, range.count);
+        putValue<uint64_t>(header, range.offset);
+        putValue<uint64_t>(header, range.size);
+    }
+
+    // Written next to the snapshot and renamed, so that other processes never
+    // see a partial one.
+    const std::string tempFileName = snapshotFileName + "." + std::to_string(std::random_device()());
+
+    std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file.write(reinterpret_cast<const char *>(lazyData_.data()), lazyData_.size());
+    file.close();
+
+    if (file.fail()) {
+        std::remove(tempFileName.c_str());
+        std::cerr << "Can't write snapshot \"" << snapshotFileName << "\"" << std::endl;
+        return;
+    }
+
+    if (std::rename(tempFileName.c_str(), snapshotFileName.c_str()) != 0) {
+        // Existing files aren't replaced on Windows.
+        std::remove(snapshotFileName.c_str());
+
+        if (std::rename(tempFileName.c_str(), snapshotFileName.c_str()) != 0) {
+            std::remove(tempFileName.c_str());
+            std::cerr << "Can't replace snapshot \"" << snapshotFileName << "\"" << std::endl;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------
 void DatFile::serializeObject(void)
 {
-    compressor_.beginCompression();
+    IoStats::Scope ioScope(IoStats::IO_DAT);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (isOperation(OP_READ)) {
+        // Whatever wasn't read from the previous file is replaced now.
+        clearLazyReads();
+
+        for (DeferredStats &deferred : deferredStats_) {
+            deferred.nanoseconds = 0;
+            deferred.allocations = 0;
+        }
+    } else {
+        // Everything is written, so everything needs to be there.
+        loadAllSections();
+    }
+
+    // Only loads and saves have stats, calculating the size has no stream
+    // to tell positions and mustn't replace the stats of the last save.
+    Stats *stats = isOperation(OP_READ) ? &loadStats_ : isOperation(OP_WRITE) ? &saveStats_ : nullptr;
+
+    if (stats) {
+        *stats = Stats();
+    }
+
+    const bool streaming = isOperation(OP_READ) && visitor_;
+    const bool lazy = isOperation(OP_READ) && !streaming && lazyLoading_;
+    const bool parallel = isOperation(OP_READ) && !streaming && !lazy && threadCount_ > 1;
+
+    // Snapshots are already decompressed.
+    const bool replay = isOperation(OP_READ) && snapshotState_ == SNAPSHOT_REPLAY;
+
+    if (!replay) {
+        compressor_.setDecompressToMemory(lazy || parallel || (decompressToMemory_ && !streaming));
+        compressor_.setThreadPool(isOperation(OP_WRITE) && threadCount_ > 1 ? &threadPool() : nullptr);
+        compressor_.beginCompression();
+    }
+
+    if (lazy || parallel) {
+        deferredData_ = dynamic_cast<MemoryStreamBuf *>(getIStream()->rdbuf());
+    }
+
+    if (isOperation(OP_READ)) {
+        sectionCache_ = SectionCache();
+    }
+
+    // Where the sections are is recorded while reading or writing the
+    // decompressed data at once.
+    SectionCache recording;
+    std::ostream *compressedStream = nullptr;
+    std::unique_ptr<VectorStreamBuf> recordBuffer;
+    std::unique_ptr<std::ostream> recordStream;
+
+    if (incrementalSaving_ && !streaming) {
+        if (isOperation(OP_WRITE)) {
+            compressedStream = getOStream();
+            recording.data.reserve(sectionCache_.data.size());
+            recordBuffer = std::make_unique<VectorStreamBuf>(recording.data);
+            recordStream = std::make_unique<std::ostream>(recordBuffer.get());
+            setOStream(*recordStream);
+            recording_ = &recording;
+        } else if (isOperation(OP_READ)) {
+            recordedData_ = dynamic_cast<const MemoryStreamBuf *>(getIStream()->rdbuf());
+            recording_ = recordedData_ ? &recording : nullptr;
+        }
+    }
+
+    // zstr's streams can't tell their position, the bytes going through them
+    // are counted for the stats instead.
+    std::istream *uncountedIStream = nullptr;
+    std::ostream *uncountedOStream = nullptr;
+    std::unique_ptr<CountingStreamBuf> countingBuffer;
+    std::unique_ptr<std::iostream> countingStream;
+
+    if (isOperation(OP_READ) && getIStream()->tellg() == std::streampos(-1)) {
+        uncountedIStream = getIStream();
+        countingBuffer = std::make_unique<CountingStreamBuf>(*uncountedIStream->rdbuf());
+        countingStream = std::make_unique<std::iostream>(countingBuffer.get());
+        countingStream->exceptions(uncountedIStream->exceptions());
+        setIStream(*countingStream);
+    } else if (isOperation(OP_WRITE) && getOStream()->tellp() == std::streampos(-1)) {
+        uncountedOStream = getOStream();
+        countingBuffer = std::make_unique<CountingStreamBuf>(*uncountedOStream->rdbuf());
+        countingStream = std::make_unique<std::iostream>(countingBuffer.get());
+        countingStream->exceptions(uncountedOStream->exceptions());
+        setOStream(*countingStream);
+    }
+
+    stats_ = stats;
+
+    try {
+        serializeData();
+
+        if (replay && nextSnapshotRange_ != snapshotRanges_.size()) {
+            throw std::ios_base::failure("Snapshot has more ranges than the file");
+        }
+    } catch (...) {
+        // The objects and the data being read need to outlive the reads.
+        waitForReads();
+        clearLazyReads();
+        deferredData_ = nullptr;
+        sectionOpen_ = false;
+        recording_ = nullptr;
+        recordedData_ = nullptr;
+        statsStart_.open = false;
+        stats_ = nullptr;
+
+        if (uncountedIStream) {
+            setIStream(*uncountedIStream);
+        } else if (uncountedOStream) {
+            setOStream(*uncountedOStream);
+        }
+
+        if (compressedStream) {
+            setOStream(*compressedStream);
+        }
+
+        throw;
+    }
+
+    if (stats) {
+        stats->bytes = statsPosition();
+    }
+
+    stats_ = nullptr;
+
+    if (uncountedIStream) {
+        setIStream(*uncountedIStream);
+    } else if (uncountedOStream) {
+        setOStream(*uncountedOStream);
+    }
+
+    std::exception_ptr error = waitForReads();
+    deferredData_ = nullptr;
+
+    if (recording_) {
+        if (compressedStream) {
+            setOStream(*compressedStream);
+            compressedStream->write(reinterpret_cast<const char *>(recording.data.data()),
+                                    recording.data.size());
+        } else if (replay || lazy) {
+            // The data stays with the snapshot or the lazy reads.
+            recording.data.assign(recordedData_->begin(), recordedData_->end());
+        } else {
+            recording.data = compressor_.takeDecompressedData();
+        }
+
+        if (!error) {
+            recording.gameVersion = getGameVersion();
+            sectionCache_ = std::move(recording);
+        }
+
+        recording_ = nullptr;
+        recordedData_ = nullptr;
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (replay) {
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    if (lazy) {
+        // Kept until all sections are loaded, and for writing a snapshot.
+        lazyData_ = compressor_.takeDecompressedData();
+
+        if (snapshotState_ != SNAPSHOT_RECORD) {
+            releaseLazyData();
+        }
+    }
+
+    compressor_.endCompression();
+
+    if (stats) {
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+//------------------------------------------------------------------------------
+DatFile::Stats DatFile::lastLoadStats(void) const
+{
+    Stats stats = loadStats_;
+
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        stats.sections[i].deferredSeconds = deferredStats_[i].nanoseconds / 1e9;
+
+        if (stats.sections[i].allocations) {
+            *stats.sections[i].allocations += deferredStats_[i].allocations;
+        }
+    }
+
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+DatFile::Stats DatFile::lastSaveStats(void) const
+{
+    return saveStats_;
+}
+
+//------------------------------------------------------------------------------
+const char *DatFile::getSectionName(Section section)
+{
+    static const char *const names[SECTION_COUNT] = {
+        "TerrainRestrictions",
+        "PlayerColours",
+        "Sounds",
+        "Graphics",
+        "TerrainBlock",
+        "RandomMaps",
+        "Effects",
+        "UnitLines",
+        "UnitHeaders",
+        "Civs",
+        "Techs",
+        "TechTree"
+    };
+
+    return section < SECTION_COUNT ? names[section] : "";
+}
+
+//------------------------------------------------------------------------------
+bool DatFile::beginSection(Section section)
+{
+    endSection();
+    currentSection_ = section;
+
+    if (stats_) {
+        statsStart_ = { std::chrono::steady_clock::now(), statsPosition(), getAllocationCount(), true };
+    }
+
+    if (!recording_) {
+        return true;
+    }
+
+    sectionOpen_ = true;
+    sectionStart_ = recordPosition();
+
+    const SectionCache::Range &cached = sectionCache_.sections[section];
+
+    if (!isOperation(OP_WRITE) || !cached.valid ||
+        sectionCache_.gameVersion != getGameVersion()) {
+        return true;
+    }
+
+    writeCached(cached);
+    stats_->sections[section].cached = true;
+
+    if (section == SECTION_CIVS) {
+        // The civilizations moved along with the section.
+        recording_->civs = sectionCache_.civs;
+
+        for (SectionCache::Range &civ : recording_->civs) {
+            civ.offset = civ.offset - cached.offset + sectionStart_;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::endSection(void)
+{
+    endSectionStats();
+
+    if (!sectionOpen_) {
+        return;
+    }
+
+    recording_->sections[currentSection_] = { sectionStart_, recordPosition() - sectionStart_, true };
+    sectionOpen_ = false;
+}
+
+//------------------------------------------------------------------------------
+size_t DatFile::recordPosition(void) const
+{
+    if (recordedData_) {
+        return recordedData_->current() - recordedData_->begin();
+    }
+
+    return recording_->data.size();
+}
+
+//------------------------------------------------------------------------------
+uint64_t DatFile::statsPosition(void)
+{
+    const std::streampos position = isOperation(OP_WRITE) ? getOStream()->tellp() :
+                                                             getIStream()->tellg();
+
+    return position == std::streampos(-1) ? 0 : uint64_t(std::streamoff(position));
+}
+
+//------------------------------------------------------------------------------
+void DatFile::endSectionStats(void)
+{
+    if (!statsStart_.open) {
+        return;
+    }
+
+    SectionStats &section = stats_->sections[currentSection_];
+    section.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsStart_.time).count();
+    section.bytes = statsPosition() - statsStart_.position;
+
+    if (isCountingAllocations()) {
+        section.allocations = getAllocationCount() - statsStart_.allocations;
+    }
+
+    statsStart_.open = false;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::writeCached(const SectionCache::Range &range)
+{
+    getOStream()->write(reinterpret_cast<const char *>(sectionCache_.data.data() + range.offset),
+                        range.size);
+}
 
+//------------------------------------------------------------------------------
+void DatFile::serializeCivs(size_t count)
+{
+    if (isOperation(OP_READ)) {
+        Civs.resize(count);
+    }
+
+    const bool reuse = isOperation(OP_WRITE) && sectionCache_.gameVersion == getGameVersion() &&
+                       sectionCache_.civs.size() == count;
+
+    recording_->civs.assign(count, SectionCache::Range());
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t start = recordPosition();
+
+        if (reuse && sectionCache_.civs[i].valid) {
+            writeCached(sectionCache_.civs[i]);
+        } else {
+            serializeSub(Civs[i]);
+        }
+
+        recording_->civs[i] = { start, recordPosition() - start, true };
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void DatFile::serializeObjects(std::vector<T> &objects, size_t count,
+                               std::vector<int32_t> *pointers)
+{
+    if (stats_) {
+        stats_->sections[currentSection_].objects +=
+            pointers ? count - std::count(pointers->begin(), pointers->begin() + count, 0) : count;
+    }
+
+    if (visitor_) {
+        streamObjects<T>(count, pointers);
+        return;
+    }
+
+    if constexpr (std::is_same_v<T, Civ>) {
+        if (recording_ && !deferredData_) {
+            serializeCivs(count);
+            return;
+        }
+    }
+
+    if (!deferredData_) {
+        if (pointers) {
+            serializeSubWithPointers<T>(objects, count, *pointers);
+        } else {
+            serialize(objects, count);
+        }
+
+        return;
+    }
+
+    // The objects are read later, the vector mustn't be touched from here on.
+    objects.resize(count);
+
+    if (recording_ && currentSection_ == SECTION_CIVS) {
+        recording_->civs.assign(count, SectionCache::Range());
+    }
+
+    deferObjects<T>(&objects, nullptr, count, pointers);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void DatFile::serializeSingle(T &object)
+{
+    if (stats_) {
+        stats_->sections[currentSection_].objects++;
+    }
+
+    if (!deferredData_) {
+        serialize<ISerializable>(object);
+        return;
+    }
+
+    deferObjects<T>(nullptr, &object, 1, nullptr);
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void DatFile::streamObjects(size_t count, const std::vector<int32_t> *pointers)
+{
+    if constexpr (std::is_same_v<T, Civ>) {
+        CivStreamer civ(*visitor_);
+
+        for (civ.index = 0; civ.index < count; ++civ.index) {
+            serializeSub(civ);
+        }
+    } else {
+        T object;
+
+        for (size_t i = 0; i < count; ++i) {
+            if (!pointers || (*pointers)[i]) {
+                object = T();
+                serializeSub(object);
+                visitObject(*visitor_, i, object);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename T>
+void DatFile::deferObjects(std::vector<T> *objects, T *single, size_t count,
+                           const std::vector<int32_t> *pointers)
+{
+    const uint8_t *data = deferredData_->begin();
+    const size_t size = deferredData_->size();
+    const GameVersion gv = getGameVersion();
+    SerializationContext *rootContext = &context();
+    DeferredStats *stats = &deferredStats_[currentSection_];
+    const char *sectionName = getSectionName(currentSection_);
+
+    auto queueRead = [&](size_t first, size_t rangeCount, size_t offset) {
+        // The objects are looked up when they are read, the vector may have
+        // reallocated since.
+        std::function<void()> read = [=]() {
+            if (objects && (objects->size() != count || (pointers && pointers->size() != count))) {
+                throw std::logic_error(std::string(sectionName) + " were changed before they were loaded");
+            }
+
+            T *range = objects ? objects->data() + first : single;
+            const int32_t *rangePointers = pointers ? pointers->data() + first : nullptr;
+
+            const auto start = std::chrono::steady_clock::now();
+            const uint64_t allocations = getAllocationCount();
+
+            ObjectRangeReader<T> reader(*rootContext, range, rangePointers, rangeCount);
+            reader.read(data, size, offset, gv);
+
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            stats->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            stats->allocations += getAllocationCount() - allocations;
+        };
+
+        if (lazyLoading_) {
+            lazyReads_[currentSection_].push_back({ first, rangeCount, std::move(read) });
+        } else {
+            pendingReads_.push_back(threadPool().submit(std::move(read)));
+        }
+    };
+
+    if (snapshotState_ == SNAPSHOT_REPLAY) {
+        // The snapshot knows where the objects are, they don't need to be
+        // skipped.
+        size_t first = 0;
+        size_t offset = deferredData_->current() - data;
+
+        while (first < count) {
+            if (nextSnapshotRange_ >= snapshotRanges_.size()) {
+                throw std::ios_base::failure("Snapshot has less ranges than the file");
+            }
+
+            const SnapshotRange &range = snapshotRanges_[nextSnapshotRange_++];
+
+            if (range.section != uint32_t(currentSection_) || range.first != first ||
+                range.offset != offset || range.count == 0 ||
+                range.count > count - first || range.size > size - offset) {
+                throw std::ios_base::failure("Snapshot range doesn't match the file");
+            }
+
+            if (recording_ && currentSection_ == SECTION_CIVS && range.count == 1) {
+                recording_->civs[first] = { offset, size_t(range.size), true };
+            }
+
+            queueRead(first, range.count, offset);
+
+            first += range.count;
+            offset += range.size;
+        }
+
+        deferredData_->skip(offset - (deferredData_->current() - data));
+        return;
+    }
+
+    // Lazily loaded civs are read one by one, everything else in chunks that
+    // the thread pool can read at the same time.
+    const size_t chunkSize = lazyLoading_ && currentSection_ == SECTION_CIVS ? 0 :
+                             PARALLEL_CHUNK_SIZE;
+
+    // The end of each object is found by skipping it, which still reads its
+    // single fields and counts into a throwaway object but passes over its
+    // strings and arrays.
+    T skipped;
+    size_t first = 0;
+    const uint8_t *firstData = deferredData_->current();
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *objectData = deferredData_->current();
+
+        if (!pointers || (*pointers)[i]) {
+            setSkipping(true);
+            serializeSub(skipped);
+            setSkipping(false);
+        }
+
+        const uint8_t *next = deferredData_->current();
+
+        if (recording_ && currentSection_ == SECTION_CIVS) {
+            recording_->civs[i] = { size_t(objectData - data), size_t(next - objectData), true };
+        }
+
+        if (size_t(next - firstData) < chunkSize && i + 1 < count) {
+            continue;
+        }
+
+        const size_t offset = firstData - data;
+        const size_t rangeCount = i + 1 - first;
+
+        if (snapshotState_ == SNAPSHOT_RECORD) {
+            snapshotRanges_.push_back({ uint32_t(currentSection_), uint32_t(first),
+                                        uint32_t(rangeCount), offset, uint64_t(next - firstData) });
+        }
+
+        queueRead(first, rangeCount, offset);
+
+        first = i + 1;
+        firstData = next;
+    }
+}
+
+//------------------------------------------------------------------------------
+ThreadPool &DatFile::threadPool(void)
+{
+    // The calling thread is one of them.
+    if (!threadPool_ || threadPool_->threadCount() != threadCount_ - 1) {
+        threadPool_ = std::make_unique<ThreadPool>(std::max<size_t>(threadCount_, 2) - 1);
+    }
+
+    return *threadPool_;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::clearLazyReads(void)
+{
+    for (std::vector<LazyRead> &reads : lazyReads_) {
+        reads.clear();
+    }
+
+    std::vector<uint8_t>().swap(lazyData_);
+    snapshotData_.reset();
+}
+
+//------------------------------------------------------------------------------
+void DatFile::releaseLazyData(void)
+{
+    for (const std::vector<LazyRead> &reads : lazyReads_) {
+        for (const LazyRead &read : reads) {
+            if (read.read) {
+                return;
+            }
+        }
+    }
+
+    clearLazyReads();
+}
+
+//------------------------------------------------------------------------------
+std::exception_ptr DatFile::waitForReads(void)
+{
+    std::exception_ptr error;
+
+    for (std::future<void> &read : pendingReads_) {
+        // Help out instead of just waiting.
+        while (read.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+               threadPool().runPendingTask()) {
+        }
+
+        try {
+            read.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    pendingReads_.clear();
+
+    return error;
+}
+
+//------------------------------------------------------------------------------
+void DatFile::serializeData(void)
+{
     serialize(FileVersion, FILE_VERSION_SIZE);
 
     // Handle all different versions while in development.
@@ -122,153 +1248,161 @@ void DatFile::serializeObject(void)
         }
     }
 
-    serializeSize<uint16_t>(count16, TerrainRestrictions.size());
-    serialize<uint16_t>(TerrainsUsed1);
+    if (beginSection(SECTION_TERRAIN_RESTRICTIONS)) {
+        serializeSize<uint16_t>(count16, TerrainRestrictions.size());
+        serialize<uint16_t>(TerrainsUsed1);
 
-    if (verbose_) {
-        std::cout << FileVersion;
-        std::cout << std::endl
-                  << "TerRestrictionCount: " << count16 << std::endl;
-        std::cout << "TerCount: " << TerrainsUsed1 << std::endl;
-    }
+        if (verbose_) {
+            std::cout << FileVersion;
+            std::cout << std::endl
+                      << "TerRestrictionCount: " << count16 << std::endl;
+            std::cout << "TerCount: " << TerrainsUsed1 << std::endl;
+        }
 
-    serialize<int32_t>(FloatPtrTerrainTables, count16);
+        serialize<int32_t>(FloatPtrTerrainTables, count16);
+
+        if (gv >= GV_AoKA) {
+            serialize<int32_t>(TerrainPassGraphicPointers, count16);
+        }
 
-    if (gv >= GV_AoKA) {
-        serialize<int32_t>(TerrainPassGraphicPointers, count16);
+        context().terrain_restriction_count = TerrainsUsed1;
+        serializeObjects(TerrainRestrictions, count16);
     }
 
-    TerrainRestriction::setTerrainCount(TerrainsUsed1);
-    serialize(TerrainRestrictions, count16);
+    if (beginSection(SECTION_PLAYER_COLOURS)) {
+        serializeSize<uint16_t>(count16, PlayerColours.size());
 
-    serializeSize<uint16_t>(count16, PlayerColours.size());
+        if (verbose_) {
+            std::cout << "PlayerColours: " << count16 << std::endl;
+        }
 
-    if (verbose_) {
-        std::cout << "PlayerColours: " << count16 << std::endl;
+        serializeObjects(PlayerColours, count16);
     }
 
-    serialize(PlayerColours, count16);
+    if (beginSection(SECTION_SOUNDS)) {
+        serializeSize<uint16_t>(count16, Sounds.size());
 
-    serializeSize<uint16_t>(count16, Sounds.size());
+        if (verbose_) {
+            std::cout << "Sounds: " << count16 << std::endl;
+        }
 
-    if (verbose_) {
-        std::cout << "Sounds: " << count16 << std::endl;
+        serializeObjects(Sounds, count16);
     }
 
-    serialize(Sounds, count16);
-
-    serializeSize<uint16_t>(count16, Graphics.size());
+    if (beginSection(SECTION_GRAPHICS)) {
+        serializeSize<uint16_t>(count16, Graphics.size());
 
-    if (gv < GV_AoE) {
-        serialize(Graphics, count16);
-    } else {
-        serialize<int32_t>(GraphicPointers, count16);
-        serializeSubWithPointers<Graphic>(Graphics, count16, GraphicPointers);
-    }
+        if (gv < GV_AoE) {
+            serializeObjects(Graphics, count16);
+        } else {
+            serialize<int32_t>(GraphicPointers, count16);
+            serializeObjects(Graphics, count16, &GraphicPointers);
+        }
 
-//    std::pos pos_cnt = tellg();
-    if (verbose_) {
-        std::cout << "Graphics: " << Graphics.size() << std::endl;
+        if (verbose_) {
+            std::cout << "Graphics: " << Graphics.size() << std::endl;
+        }
     }
 
-    serialize<ISerializable>(TerrainBlock);
+    if (beginSection(SECTION_TERRAIN_BLOCK)) {
+        serializeSingle(TerrainBlock);
 
-    if (verbose_) {
-        std::cout << "Tile sizes: " << TerrainBlock.TileSizes.size() << std::endl;
-        std::cout << "Terrains: " << TerrainBlock.Terrains.size() << std::endl;
-        std::cout << "Borders: " << TerrainBlock.TerrainBorders.size() << std::endl;
-        std::cout << "Some bytes: " << TerrainBlock.SomeBytes.size() << std::endl;
-        std::cout << "Some ints: " << TerrainBlock.SomeInt32.size() << std::endl;
-//        pos_cnt = tellg() - pos_cnt;
-//        std::cout << "Terrain block "
-//                  << "(0x" << std::hex << pos_cnt;
-//        std::cout << " to 0x" << tellg() << std::dec << ") size " << pos_cnt << std::endl;
+        if (verbose_) {
+            std::cout << "Tile sizes: " << TerrainBlock.TileSizes.size() << std::endl;
+            std::cout << "Terrains: " << TerrainBlock.Terrains.size() << std::endl;
+            std::cout << "Borders: " << TerrainBlock.TerrainBorders.size() << std::endl;
+            std::cout << "Some bytes: " << TerrainBlock.SomeBytes.size() << std::endl;
+            std::cout << "Some ints: " << TerrainBlock.SomeInt32.size() << std::endl;
+        }
     }
 
     // This data seems to be needed only in AoE and RoR.
     // In later games it is removable.
     // It exists in Star Wars games too, but is not used.
-    serialize<ISerializable>(RandomMaps);
+    if (beginSection(SECTION_RANDOM_MAPS)) {
+        serializeSingle(RandomMaps);
 
-    if (verbose_) {
-        std::cout << "Random maps: " << RandomMaps.Maps.size() << std::endl;
+        if (verbose_) {
+            std::cout << "Random maps: " << RandomMaps.Maps.size() << std::endl;
+        }
     }
 
-    serializeSize<uint32_t>(count32, Effects.size());
+    if (beginSection(SECTION_EFFECTS)) {
+        serializeSize<uint32_t>(count32, Effects.size());
 
-    if (verbose_) {
-        std::cout << "Effects: " << count32 << std::endl;
-    }
+        if (verbose_) {
+            std::cout << "Effects: " << count32 << std::endl;
+        }
 
-    serialize(Effects, count32);
+        serializeObjects(Effects, count32);
+    }
 
-    if (gv >= GV_SWGB) { //pos: 0x111936
+    if (gv >= GV_SWGB && beginSection(SECTION_UNIT_LINES)) { //pos: 0x111936
         serializeSize<uint16_t>(count16, UnitLines.size());
-        serialize(UnitLines, count16);
+        serializeObjects(UnitLines, count16);
     }
 
-    if (gv >= GV_AoK) {
+    if (gv >= GV_AoK && beginSection(SECTION_UNIT_HEADERS)) {
         serializeSize<uint32_t>(count32, UnitHeaders.size());
 
         if (verbose_) {
             std::cout << "Units: " << count32 << std::endl;
         }
 
-        serialize(UnitHeaders, count32);
+        serializeObjects(UnitHeaders, count32);
     }
 
-    serializeSize<uint16_t>(count16, Civs.size());
+    if (beginSection(SECTION_CIVS)) {
+        serializeSize<uint16_t>(count16, Civs.size());
 
-    if (verbose_) {
-        std::cout << "Civs: " << count16 << std::endl;
-    }
+        if (verbose_) {
+            std::cout << "Civs: " << count16 << std::endl;
+        }
 
-    serialize(Civs, count16);
+        serializeObjects(Civs, count16);
 
-    if (gv >= GV_SWGB) {
-        serialize<int8_t>(SUnknown7);
+        if (gv >= GV_SWGB) {
+            serialize<int8_t>(SUnknown7);
+        }
     }
 
-    serializeSize<uint16_t>(count16, Techs.size());
+    if (beginSection(SECTION_TECHS)) {
+        serializeSize<uint16_t>(count16, Techs.size());
 
-    if (verbose_) {
-        std::cout << "Techs: " << count16 << std::endl;
-    }
+        if (verbose_) {
+            std::cout << "Techs: " << count16 << std::endl;
+        }
 
-    serialize(Techs, count16);
+        serializeObjects(Techs, count16);
 
-//    if (verbose_) {
-//        pos_cnt = tellg();
-//        std::cout << "TechTrees (before eof) (0x" << std::hex << pos_cnt;
-//    }
+        if (gv >= GV_SWGB) {
+            serialize<int8_t>(SUnknown8);
+        }
 
-    if (gv >= GV_SWGB) {
-        serialize<int8_t>(SUnknown8);
+        if (gv >= GV_AoKA) { // 9.38
+            serialize<int32_t>(TimeSlice);
+            serialize<int32_t>(UnitKillRate);
+            serialize<int32_t>(UnitKillTotal);
+            serialize<int32_t>(UnitHitPointRate);
+            serialize<int32_t>(UnitHitPointTotal);
+            serialize<int32_t>(RazingKillRate);
+            serialize<int32_t>(RazingKillTotal);
+        }
     }
 
-    if (gv >= GV_AoKA) { // 9.38
-        serialize<int32_t>(TimeSlice);
-        serialize<int32_t>(UnitKillRate);
-        serialize<int32_t>(UnitKillTotal);
-        serialize<int32_t>(UnitHitPointRate);
-        serialize<int32_t>(UnitHitPointTotal);
-        serialize<int32_t>(RazingKillRate);
-        serialize<int32_t>(RazingKillTotal);
-
-        serialize<ISerializable>(TechTree);
+    if (gv >= GV_AoKA && beginSection(SECTION_TECH_TREE)) {
+        serializeSingle(TechTree);
     }
 
-//    if (verbose_) {
-//        pos_cnt = tellg() - pos_cnt;
-//        std::cout << " to 0x" << tellg() << std::dec << ") size " << pos_cnt << std::endl;
-//    }
-
-    compressor_.endCompression();
+    endSection();
 }
 
 //------------------------------------------------------------------------------
 void DatFile::unload()
 {
+    clearLazyReads();
+    sectionCache_ = SectionCache();
+
     FloatPtrTerrainTables.clear();
     TerrainPassGraphicPointers.clear();
     TerrainRestrictions.clear();
@@ -0,0 +1,770 @@
+/*
+    Object-level differences between two DAT files
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/dat/DatPatch.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace genie {
+
+namespace {
+
+/// Start of every patch file
+const std::string PATCH_MAGIC = "GDATPTCH";
+
+/// Changed whenever the layout of patches or of the file fields changes.
+constexpr uint32_t PATCH_VERSION = 1;
+
+/// Equal bytes between two changed runs that are kept in one change, instead
+/// of starting a new one.
+constexpr size_t CHANGE_MERGE_GAP = 8;
+
+/// Bytes of a change that print() shows
+constexpr size_t PRINTED_BYTES = 16;
+
+const char *const OBJECT_NAMES[DatPatch::OBJECT_TYPE_COUNT] = {
+    "File",
+    "TerrainRestrictions",
+    "PlayerColours",
+    "Sounds",
+    "Graphics",
+    "TerrainBlock",
+    "RandomMaps",
+    "Effects",
+    "UnitLines",
+    "UnitHeaders",
+    "Civs",
+    "Units",
+    "Techs",
+    "TechTree",
+};
+
+/// Sections the objects are saved in
+const DatFile::Section OBJECT_SECTIONS[DatPatch::OBJECT_TYPE_COUNT] = {
+    DatFile::SECTION_COUNT,
+    DatFile::SECTION_TERRAIN_RESTRICTIONS,
+    DatFile::SECTION_PLAYER_COLOURS,
+    DatFile::SECTION_SOUNDS,
+    DatFile::SECTION_GRAPHICS,
+    DatFile::SECTION_TERRAIN_BLOCK,
+    DatFile::SECTION_RANDOM_MAPS,
+    DatFile::SECTION_EFFECTS,
+    DatFile::SECTION_UNIT_LINES,
+    DatFile::SECTION_UNIT_HEADERS,
+    DatFile::SECTION_CIVS,
+    DatFile::SECTION_CIVS,
+    DatFile::SECTION_TECHS,
+    DatFile::SECTION_TECH_TREE,
+};
+
+//------------------------------------------------------------------------------
+/// Fields of a DAT file that aren't part of its objects, and the counts of
+/// its object vectors.
+//
+class FileFields : public ISerializable
+{
+public:
+    explicit FileFields(DatFile &dat) :
+        dat_(dat)
+    {
+    }
+
+    /// Number of objects of each vector type
+    std::array<uint32_t, DatPatch::OBJECT_TYPE_COUNT> counts{};
+
+private:
+    DatFile &dat_;
+
+    void serializeObject(void) override
+    {
+        const GameVersion gv = getGameVersion();
+
+        // Fields the game version doesn't have are left uninitialized.
+        serialize(dat_.FileVersion, DatFile::FILE_VERSION_SIZE);
+        serialize<uint16_t>(dat_.TerrainsUsed1);
+
+        if (gv >= GV_SWGB) {
+            serialize<int32_t>(dat_.SUnknown2);
+            serialize<int32_t>(dat_.SUnknown3);
+            serialize<int32_t>(dat_.SUnknown4);
+            serialize<int32_t>(dat_.SUnknown5);
+            serialize<int8_t>(dat_.SUnknown7);
+            serialize<int8_t>(dat_.SUnknown8);
+        }
+
+        if (gv >= GV_AoKA) {
+            serialize<int32_t>(dat_.TimeSlice);
+            serialize<int32_t>(dat_.UnitKillRate);
+            serialize<int32_t>(dat_.UnitKillTotal);
+            serialize<int32_t>(dat_.UnitHitPointRate);
+            serialize<int32_t>(dat_.UnitHitPointTotal);
+            serialize<int32_t>(dat_.RazingKillRate);
+            serialize<int32_t>(dat_.RazingKillTotal);
+        }
+
+        serializePointers(dat_.FloatPtrTerrainTables);
+        serializePointers(dat_.TerrainPassGraphicPointers);
+        serializePointers(dat_.GraphicPointers);
+
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_TERRAIN_RESTRICTION], dat_.TerrainRestrictions.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_PLAYER_COLOUR], dat_.PlayerColours.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_SOUND], dat_.Sounds.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_GRAPHIC], dat_.Graphics.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_EFFECT], dat_.Effects.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_UNIT_LINE], dat_.UnitLines.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_UNIT_HEADER], dat_.UnitHeaders.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_CIV], dat_.Civs.size());
+        serializeSize<uint32_t>(counts[DatPatch::OBJECT_TECH], dat_.Techs.size());
+    }
+
+    void serializePointers(std::vector<int32_t> &pointers)
+    {
+        uint32_t count{};
+        serializeSize<uint32_t>(count, pointers.size());
+        serialize<int32_t>(pointers, count);
+    }
+};
+
+//------------------------------------------------------------------------------
+/// The part of a civilization before its units. Only a civilization can
+/// serialize its fields, so the civilization is moved into this object while
+/// it exists.
+//
+class CivHeader : public Civ
+{
+public:
+    CivHeader() = default;
+
+    explicit CivHeader(Civ &civ) :
+        civ_(&civ)
+    {
+        static_cast<Civ &>(*this) = std::move(civ);
+    }
+
+    ~CivHeader() override
+    {
+        if (civ_) {
+            *civ_ = std::move(static_cast<Civ &>(*this));
+        }
+    }
+
+private:
+    Civ *civ_ = nullptr;
+
+    void serializeObject(void) override
+    {
+        serializeHeader();
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Serializes single objects of a DAT file on their own.
+//
+class ObjectArchive : public ISerializable
+{
+public:
+    ObjectArchive(GameVersion gv, uint16_t terrainCount)
+    {
+        setGameVersion(gv);
+        rootContext_.terrain_restriction_count = terrainCount;
+    }
+
+    void setTerrainCount(uint16_t terrainCount)
+    {
+        rootContext_.terrain_restriction_count = terrainCount;
+    }
+
+    /// Appends the serialized object to data.
+    void write(ISerializable &object, std::vector<uint8_t> &data)
+    {
+        VectorStreamBuf buffer(data);
+        std::ostream stream(&buffer);
+
+        object_ = &object;
+        writeObject(stream);
+    }
+
+    void read(ISerializable &object, const std::vector<uint8_t> &data)
+    {
+        MemoryStreamBuf buffer(data.data(), data.size());
+        std::istream stream(&buffer);
+
+        object_ = &object;
+        readObject(stream);
+
+        if (stream.fail() || buffer.remaining() != 0) {
+            throw std::ios_base::failure("Patched object doesn't read back");
+        }
+    }
+
+private:
+    SerializationContext rootContext_;
+    ISerializable *object_ = nullptr;
+
+    SerializationContext *ownContext(void) override
+    {
+        return &rootContext_;
+    }
+
+    void serializeObject(void) override
+    {
+        serializeSub(*object_);
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Whether an object of a vector with pointers is stored. Objects with a null
+/// pointer aren't, they are left empty.
+//
+bool isStored(const std::vector<int32_t> *pointers, size_t index)
+{
+    return !pointers || (index < pointers->size() && (*pointers)[index]);
+}
+
+//------------------------------------------------------------------------------
+/// Calls visit(type, civ, index, object) for all objects of dat in the order
+/// they are stored, each civilization followed by its units. Objects that
+/// aren't stored are passed as nullptr.
+//
+template <typename F>
+void forEachObject(DatFile &dat, F &&visit)
+{
+    FileFields fields(dat);
+    visit(DatPatch::OBJECT_FILE, 0, 0, &fields);
+
+    auto visitAll = [&](DatPatch::ObjectType type, auto &objects,
+                        const std::vector<int32_t> *pointers = nullptr) {
+        for (size_t i = 0; i < objects.size(); ++i) {
+            visit(type, 0, uint32_t(i), isStored(pointers, i) ? &objects[i] : nullptr);
+        }
+    };
+
+    visitAll(DatPatch::OBJECT_TERRAIN_RESTRICTION, dat.TerrainRestrictions);
+    visitAll(DatPatch::OBJECT_PLAYER_COLOUR, dat.PlayerColours);
+    visitAll(DatPatch::OBJECT_SOUND, dat.Sounds);
+    visitAll(DatPatch::OBJECT_GRAPHIC, dat.Graphics,
+             dat.getGameVersion() >= GV_AoE ? &dat.GraphicPointers : nullptr);
+    visit(DatPatch::OBJECT_TERRAIN_BLOCK, 0, 0, &dat.TerrainBlock);
+    visit(DatPatch::OBJECT_RANDOM_MAPS, 0, 0, &dat.RandomMaps);
+    visitAll(DatPatch::OBJECT_EFFECT, dat.Effects);
+    visitAll(DatPatch::OBJECT_UNIT_LINE, dat.UnitLines);
+    visitAll(DatPatch::OBJECT_UNIT_HEADER, dat.UnitHeaders);
+
+    for (size_t i = 0; i < dat.Civs.size(); ++i) {
+        {
+            CivHeader header(dat.Civs[i]);
+            visit(DatPatch::OBJECT_CIV, 0, uint32_t(i), &header);
+        }
+
+        Civ &civ = dat.Civs[i];
+
+        for (size_t j = 0; j < civ.Units.size(); ++j) {
+            visit(DatPatch::OBJECT_UNIT, uint32_t(i), uint32_t(j),
+                  isStored(&civ.UnitPointers, j) ? &civ.Units[j] : nullptr);
+        }
+    }
+
+    visitAll(DatPatch::OBJECT_TECH, dat.Techs);
+
+    if (dat.getGameVersion() >= GV_AoKA) {
+        visit(DatPatch::OBJECT_TECH_TREE, 0, 0, &dat.TechTree);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Number of objects in each vector of dat, like FileFields::counts.
+//
+std::array<uint32_t, DatPatch::OBJECT_TYPE_COUNT> countObjects(const DatFile &dat)
+{
+    std::array<uint32_t, DatPatch::OBJECT_TYPE_COUNT> counts{};
+
+    counts[DatPatch::OBJECT_TERRAIN_RESTRICTION] = uint32_t(dat.TerrainRestrictions.size());
+    counts[DatPatch::OBJECT_PLAYER_COLOUR] = uint32_t(dat.PlayerColours.size());
+    counts[DatPatch::OBJECT_SOUND] = uint32_t(dat.Sounds.size());
+    counts[DatPatch::OBJECT_GRAPHIC] = uint32_t(dat.Graphics.size());
+    counts[DatPatch::OBJECT_EFFECT] = uint32_t(dat.Effects.size());
+    counts[DatPatch::OBJECT_UNIT_LINE] = uint32_t(dat.UnitLines.size());
+    counts[DatPatch::OBJECT_UNIT_HEADER] = uint32_t(dat.UnitHeaders.size());
+    counts[DatPatch::OBJECT_CIV] = uint32_t(dat.Civs.size());
+    counts[DatPatch::OBJECT_TECH] = uint32_t(dat.Techs.size());
+
+    return counts;
+}
+
+//------------------------------------------------------------------------------
+/// Resizes the vectors of dat to the counts of a patch, reading their
+/// sections first so that no lazy read is left pointing into them.
+//
+void resizeObjects(DatFile &dat, const std::array<uint32_t, DatPatch::OBJECT_TYPE_COUNT> &counts)
+{
+    auto resize = [&](auto &objects, DatPatch::ObjectType type, DatFile::Section section) {
+        if (objects.size() != counts[type]) {
+            dat.loadSection(section);
+            objects.resize(counts[type]);
+        }
+    };
+
+    resize(dat.TerrainRestrictions, DatPatch::OBJECT_TERRAIN_RESTRICTION, DatFile::SECTION_TERRAIN_RESTRICTIONS);
+    resize(dat.PlayerColours, DatPatch::OBJECT_PLAYER_COLOUR, DatFile::SECTION_PLAYER_COLOURS);
+    resize(dat.Sounds, DatPatch::OBJECT_SOUND, DatFile::SECTION_SOUNDS);
+    resize(dat.Graphics, DatPatch::OBJECT_GRAPHIC, DatFile::SECTION_GRAPHICS);
+    resize(dat.Effects, DatPatch::OBJECT_EFFECT, DatFile::SECTION_EFFECTS);
+    resize(dat.UnitLines, DatPatch::OBJECT_UNIT_LINE, DatFile::SECTION_UNIT_LINES);
+    resize(dat.UnitHeaders, DatPatch::OBJECT_UNIT_HEADER, DatFile::SECTION_UNIT_HEADERS);
+    resize(dat.Civs, DatPatch::OBJECT_CIV, DatFile::SECTION_CIVS);
+    resize(dat.Techs, DatPatch::OBJECT_TECH, DatFile::SECTION_TECHS);
+}
+
+//------------------------------------------------------------------------------
+/// Returns an object of a vector or a single object of dat, reading its
+/// section first.
+//
+ISerializable &findObject(DatFile &dat, DatPatch::ObjectType type, size_t index)
+{
+    switch (type) {
+    case DatPatch::OBJECT_TERRAIN_RESTRICTION:
+        return dat.getTerrainRestrictions().at(index);
+    case DatPatch::OBJECT_PLAYER_COLOUR:
+        return dat.getPlayerColours().at(index);
+    case DatPatch::OBJECT_SOUND:
+        return dat.getSounds().at(index);
+    case DatPatch::OBJECT_GRAPHIC:
+        return dat.getGraphics().at(index);
+    case DatPatch::OBJECT_TERRAIN_BLOCK:
+        return dat.getTerrainBlock();
+    case DatPatch::OBJECT_RANDOM_MAPS:
+        return dat.getRandomMaps();
+    case DatPatch::OBJECT_EFFECT:
+        return dat.getEffects().at(index);
+    case DatPatch::OBJECT_UNIT_LINE:
+        return dat.getUnitLines().at(index);
+    case DatPatch::OBJECT_UNIT_HEADER:
+        return dat.getUnitHeaders().at(index);
+    case DatPatch::OBJECT_TECH:
+        return dat.getTechs().at(index);
+    case DatPatch::OBJECT_TECH_TREE:
+        return dat.getTechTree();
+    default:
+        throw std::ios_base::failure("Invalid patch object type");
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Appends the changes that turn before into after.
+//
+void diffBytes(const uint8_t *before, size_t beforeSize,
+               const uint8_t *after, size_t afterSize,
+               std::vector<DatPatch::Change> &changes)
+{
+    auto addChange = [&](size_t offset, size_t beforeEnd, size_t afterEnd) {
+        DatPatch::Change change;
+        change.offset = uint32_t(offset);
+        change.before.assign(before + offset, before + beforeEnd);
+        change.after.assign(after + offset, after + afterEnd);
+        changes.push_back(std::move(change));
+    };
+
+    if (beforeSize == afterSize) {
+        size_t i = 0;
+
+        while (i < beforeSize) {
+            if (before[i] == after[i]) {
+                ++i;
+                continue;
+            }
+
+            size_t last = i;
+
+            for (size_t j = i + 1; j < beforeSize && j - last <= CHANGE_MERGE_GAP; ++j) {
+                if (before[j] != after[j]) {
+                    last = j;
+                }
+            }
+
+            addChange(i, last + 1, last + 1);
+            i = last + 1;
+        }
+
+        return;
+    }
+
+    // Everything in between is replaced if the size changes.
+    const size_t shorter = std::min(beforeSize, afterSize);
+    size_t prefix = 0;
+    size_t suffix = 0;
+
+    while (prefix < shorter && before[prefix] == after[prefix]) {
+        ++prefix;
+    }
+
+    while (suffix < shorter - prefix &&
+           before[beforeSize - 1 - suffix] == after[afterSize - 1 - suffix]) {
+        ++suffix;
+    }
+
+    addChange(prefix, beforeSize - suffix, afterSize - suffix);
+}
+
+//------------------------------------------------------------------------------
+void printBytes(std::ostream &out, const std::vector<uint8_t> &bytes)
+{
+    char hex[4];
+
+    for (size_t i = 0; i < std::min(bytes.size(), PRINTED_BYTES); ++i) {
+        std::snprintf(hex, sizeof hex, i == 0 ? "%02x" : " %02x", bytes[i]);
+        out << hex;
+    }
+
+    if (bytes.size() > PRINTED_BYTES) {
+        out << " ... (" << bytes.size() << " bytes)";
+    } else if (bytes.empty()) {
+        out << "(none)";
+    }
+}
+} // namespace
+
+//------------------------------------------------------------------------------
+DatPatch::Base::Base(DatFile &dat) :
+    gameVersion_(dat.getGameVersion())
+{
+    dat.loadAllSections();
+
+    ObjectArchive archive(gameVersion_, dat.TerrainsUsed1);
+
+    forEachObject(dat, [&](ObjectType type, uint32_t civ, uint32_t, ISerializable *object) {
+        Range range;
+        range.offset = data_.size();
+
+        if (object) {
+            archive.write(*object, data_);
+        }
+
+        range.size = data_.size() - range.offset;
+
+        if (type == OBJECT_UNIT) {
+            units_[civ].push_back(range);
+        } else {
+            objects_[type].push_back(range);
+
+            if (type == OBJECT_CIV) {
+                units_.emplace_back();
+            }
+        }
+    });
+}
+
+//------------------------------------------------------------------------------
+GameVersion DatPatch::Base::getGameVersion(void) const
+{
+    return gameVersion_;
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::create(DatFile &base, DatFile &target)
+{
+    create(Base(base), target);
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::create(const Base &base, DatFile &target)
+{
+    if (base.gameVersion_ != target.getGameVersion()) {
+        throw std::ios_base::failure("Can't compare DAT files of different game versions");
+    }
+
+    target.loadAllSections();
+
+    entries_.clear();
+    setGameVersion(base.gameVersion_);
+
+    ObjectArchive archive(base.gameVersion_, target.TerrainsUsed1);
+    std::vector<uint8_t> data;
+
+    forEachObject(target, [&](ObjectType type, uint32_t civ, uint32_t index, ISerializable *object) {
+        if (!object) {
+            return;
+        }
+
+        data.clear();
+        archive.write(*object, data);
+
+        const std::vector<Base::Range> *ranges = &base.objects_[type];
+
+        if (type == OBJECT_UNIT) {
+            ranges = civ < base.units_.size() ? &base.units_[civ] : nullptr;
+        }
+
+        // Added objects and ones that weren't stored are compared to nothing.
+        const uint8_t *before = nullptr;
+        size_t beforeSize = 0;
+
+        if (ranges && index < ranges->size()) {
+            before = base.data_.data() + (*ranges)[index].offset;
+            beforeSize = (*ranges)[index].size;
+        }
+
+        if (beforeSize == data.size() && std::equal(data.begin(), data.end(), before)) {
+            return;
+        }
+
+        Entry entry;
+        entry.type = type;
+        entry.civ = civ;
+        entry.index = index;
+        diffBytes(before, beforeSize, data.data(), data.size(), entry.changes);
+        entries_.push_back(std::move(entry));
+    });
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::apply(DatFile &dat) const
+{
+    if (dat.getGameVersion() != getGameVersion()) {
+        throw std::ios_base::failure("DAT patch is for a different game version");
+    }
+
+    // Objects are serialized with the terrain count of the base file, and
+    // read back with the patched one.
+    const uint16_t baseTerrainCount = dat.TerrainsUsed1;
+    ObjectArchive archive(getGameVersion(), baseTerrainCount);
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> patched;
+
+    // Objects the base file doesn't have or store were compared to nothing.
+    const std::array<uint32_t, OBJECT_TYPE_COUNT> baseCounts = countObjects(dat);
+    const std::vector<int32_t> baseGraphicPointers = dat.GraphicPointers;
+    std::map<uint32_t, std::vector<int32_t>> baseUnitPointers;
+
+    auto patch = [&](const Entry &entry, ISerializable &object, bool added) {
+        data.clear();
+
+        if (!added) {
+            archive.setTerrainCount(baseTerrainCount);
+            archive.write(object, data);
+        }
+
+        patched.clear();
+        size_t position = 0;
+
+        for (const Change &change : entry.changes) {
+            if (change.offset < position || change.offset > data.size() ||
+                change.before.size() > data.size() - change.offset ||
+                !std::equal(change.before.begin(), change.before.end(), data.begin() + change.offset)) {
+                throw std::ios_base::failure("DAT patch doesn't match " + getObjectName(entry));
+            }
+
+            patched.insert(patched.end(), data.begin() + position, data.begin() + change.offset);
+            patched.insert(patched.end(), change.after.begin(), change.after.end());
+            position = change.offset + change.before.size();
+        }
+
+        patched.insert(patched.end(), data.begin() + position, data.end());
+
+        archive.setTerrainCount(dat.TerrainsUsed1);
+        archive.read(object, patched);
+    };
+
+    for (const Entry &entry : entries_) {
+        switch (entry.type) {
+        case OBJECT_FILE: {
+            // Lazy reads of the graphics use the pointers.
+            dat.loadSection(DatFile::SECTION_GRAPHICS);
+
+            FileFields fields(dat);
+            patch(entry, fields, false);
+            resizeObjects(dat, fields.counts);
+
+            // The fields are spread over the sections.
+            for (size_t section = 0; section < DatFile::SECTION_COUNT; ++section) {
+                dat.invalidateSection(DatFile::Section(section));
+            }
+
+            break;
+        }
+
+        case OBJECT_CIV: {
+            const bool added = entry.index >= baseCounts[OBJECT_CIV];
+            Civ &civ = dat.getCiv(entry.index);
+
+            if (added) {
+                baseUnitPointers[entry.index].clear();
+            } else {
+                baseUnitPointers[entry.index] = civ.UnitPointers;
+            }
+
+            {
+                CivHeader header(civ);
+                patch(entry, header, added);
+            }
+
+            civ.Units.resize(civ.UnitPointers.size());
+            dat.invalidateCiv(entry.index);
+            break;
+        }
+
+        case OBJECT_UNIT: {
+            Civ &civ = dat.getCiv(entry.civ);
+            const auto pointers = baseUnitPointers.find(entry.civ);
+
+            patch(entry, civ.Units.at(entry.index),
+                  !isStored(pointers != baseUnitPointers.end() ? &pointers->second : &civ.UnitPointers,
+                            entry.index));
+            dat.invalidateCiv(entry.civ);
+            break;
+        }
+
+        default: {
+            const bool single = entry.type == OBJECT_TERRAIN_BLOCK || entry.type == OBJECT_RANDOM_MAPS ||
+                                entry.type == OBJECT_TECH_TREE;
+
+            bool added = !single && entry.index >= baseCounts[entry.type];
+
+            if (entry.type == OBJECT_GRAPHIC && getGameVersion() >= GV_AoE) {
+                added = !isStored(&baseGraphicPointers, entry.index);
+            }
+
+            patch(entry, findObject(dat, entry.type, entry.index), added);
+            dat.invalidateSection(OBJECT_SECTIONS[entry.type]);
+            break;
+        }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+const std::vector<DatPatch::Entry> &DatPatch::getEntries(void) const
+{
+    return entries_;
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::print(std::ostream &out) const
+{
+    char offset[16];
+
+    for (const Entry &entry : entries_) {
+        const std::string name = getObjectName(entry);
+
+        for (const Change &change : entry.changes) {
+            std::snprintf(offset, sizeof offset, " +0x%x: ", change.offset);
+
+            out << name << offset;
+            printBytes(out, change.before);
+            out << " -> ";
+            printBytes(out, change.after);
+            out << std::endl;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+std::string DatPatch::getObjectName(const Entry &entry)
+{
+    if (entry.type >= OBJECT_TYPE_COUNT) {
+        return "Unknown";
+    }
+
+    switch (entry.type) {
+    case OBJECT_FILE:
+    case OBJECT_TERRAIN_BLOCK:
+    case OBJECT_RANDOM_MAPS:
+    case OBJECT_TECH_TREE:
+        return OBJECT_NAMES[entry.type];
+
+    case OBJECT_UNIT:
+        return "Civs[" + std::to_string(entry.civ) + "].Units[" + std::to_string(entry.index) + "]";
+
+    default:
+        return std::string(OBJECT_NAMES[entry.type]) + "[" + std::to_string(entry.index) + "]";
+    }
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::serializeObject(void)
+{
+    std::string magic = PATCH_MAGIC;
+    serialize(magic, PATCH_MAGIC.size());
+
+    if (isOperation(OP_READ) && magic != PATCH_MAGIC) {
+        throw std::ios_base::failure("Not a DAT patch");
+    }
+
+    uint32_t version = PATCH_VERSION;
+    serialize<uint32_t>(version);
+
+    if (isOperation(OP_READ) && version != PATCH_VERSION) {
+        throw std::ios_base::failure("Unsupported DAT patch version " + std::to_string(version));
+    }
+
+    uint32_t gameVersion = getGameVersion();
+    serialize<uint32_t>(gameVersion);
+
+    if (isOperation(OP_READ)) {
+        setGameVersion(GameVersion(gameVersion));
+    }
+
+    uint32_t entryCount{};
+    serializeSize<uint32_t>(entryCount, entries_.size());
+
+    if (isOperation(OP_READ)) {
+        entries_.resize(entryCount);
+    }
+
+    for (Entry &entry : entries_) {
+        uint8_t type = entry.type;
+        serialize<uint8_t>(type);
+        entry.type = ObjectType(type);
+
+        serialize<uint32_t>(entry.civ);
+        serialize<uint32_t>(entry.index);
+
+        uint32_t changeCount{};
+        serializeSize<uint32_t>(changeCount, entry.changes.size());
+
+        if (isOperation(OP_READ)) {
+            if (entry.type >= OBJECT_TYPE_COUNT || getIStream()->fail()) {
+                throw std::ios_base::failure("DAT patch is corrupt");
+            }
+
+            entry.changes.resize(changeCount);
+        }
+
+        for (Change &change : entry.changes) {
+            uint32_t size{};
+
+            serialize<uint32_t>(change.offset);
+            serializeSize<uint32_t>(size, change.before.size());
+            serialize<uint8_t>(change.before, size);
+            serializeSize<uint32_t>(size, change.after.size());
+            serialize<uint8_t>(change.after, size);
+        }
+    }
+
+    if (isOperation(OP_READ) && getIStream()->fail()) {
+        throw std::ios_base::failure("DAT patch is truncated");
+    }
+}
+
+//------------------------------------------------------------------------------
+void DatPatch::unload(void)
+{
+    entries_.clear();
+}
+} // namespace genie
@@ -24,12 +24,10 @@
 
 namespace genie {
 
-unsigned short TerrainRestriction::terrain_count_ = 0;
-
 //------------------------------------------------------------------------------
-TerrainRestriction::TerrainRestriction() :
-    PassableBuildableDmgMultiplier(terrain_count_),
-    TerrainPassGraphics(terrain_count_)
+TerrainRestriction::TerrainRestriction(unsigned short terrainCount) :
+    PassableBuildableDmgMultiplier(terrainCount),
+    TerrainPassGraphics(terrainCount)
 {
 }
 
@@ -41,21 +39,17 @@ void TerrainRestriction::setGameVersion(GameVersion gv)
     updateGameVersion(TerrainPassGraphics);
 }
 
-//------------------------------------------------------------------------------
-void TerrainRestriction::setTerrainCount(unsigned short cnt)
-{
-    terrain_count_ = cnt;
-}
-
 //------------------------------------------------------------------------------
 void TerrainRestriction::serializeObject(void)
 {
-    serialize<float>(PassableBuildableDmgMultiplier, terrain_count_);
+    const unsigned short terrainCount = context().terrain_restriction_count;
+
+    serialize<float>(PassableBuildableDmgMultiplier, terrainCount);
 
     GameVersion gv = getGameVersion();
 
     if (gv >= GV_AoKA || (gv >= GV_T4 && gv <= GV_LatestTap)) {
-        serialize(TerrainPassGraphics, terrain_count_);
+        serialize(TerrainPassGraphics, terrainCount);
     }
 }
 } // namespace genie
@@ -23,10 +23,10 @@
 namespace genie {
 
 namespace unit {
-void AttackOrArmor::serializeObject(void)
+void AttackOrArmor::serializeFields(RecordArchive &archive)
 {
-    serialize<int16_t>(Class);
-    serialize<int16_t>(Amount);
+    archive(Class);
+    archive(Amount);
 }
 } // namespace unit
 } // namespace genie
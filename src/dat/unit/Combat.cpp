@@ -24,14 +24,6 @@ namespace genie {
 
 namespace unit {
 //------------------------------------------------------------------------------
-void Combat::setGameVersion(GameVersion gv)
-{
-    ISerializable::setGameVersion(gv);
-
-    updateGameVersion(Attacks);
-    updateGameVersion(Armours);
-}
-
 void Combat::serializeObject(void)
 {
     GameVersion gv = getGameVersion();
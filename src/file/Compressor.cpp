@@ -18,13 +18,265 @@
 */
 
 #include "genie/file/Compressor.h"
+#include "genie/file/MappedFile.h"
+#include "genie/util/ThreadPool.h"
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <future>
 #include <vector>
 
 #include <zstr.hpp>
 
 namespace genie {
 
+namespace {
+
+/// Uncompressed bytes per chunk when compressing in parallel. Big enough
+/// that the dictionary and flush overhead doesn't matter, small enough to
+/// keep all threads busy with DAT files of a few MB.
+const size_t COMPRESSION_CHUNK_SIZE = 256 * 1024;
+
+/// Bytes preceding a chunk that it is primed with, the deflate window.
+const size_t COMPRESSION_DICTIONARY_SIZE = 32 * 1024;
+
+//------------------------------------------------------------------------------
+/// Deflates size bytes at data into a raw deflate fragment. All but the last
+/// chunk end with a sync flush, so they end on a byte boundary and without
+/// the final block bit, and the fragments can be concatenated.
+//
+std::vector<uint8_t> deflateChunk(const uint8_t *data, size_t size,
+                                  const uint8_t *dictionary, size_t dictionarySize,
+                                  int level, bool last)
+{
+    z_stream stream{};
+
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::ios_base::failure("Failed to initialize deflate");
+    }
+
+    // The bundled miniz can't prime the window, the chunks are still valid
+    // but compress slightly worse.
+#ifndef MZ_VERSION
+    if (dictionarySize > 0) {
+        deflateSetDictionary(&stream, dictionary, dictionarySize);
+    }
+#else
+    (void)dictionary;
+    (void)dictionarySize;
+#endif
+
+    // Room for the sync flush marker on top of the bound.
+    std::vector<uint8_t> compressed(deflateBound(&stream, size) + 16);
+
+    stream.next_in = const_cast<uint8_t *>(data);
+    stream.avail_in = size;
+
+    int result = Z_OK;
+
+    for (;;) {
+        const size_t used = stream.total_out;
+        stream.next_out = compressed.data() + used;
+        stream.avail_out = compressed.size() - used;
+
+        result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+        if (result == Z_STREAM_ERROR || stream.avail_out > 0 || result == Z_STREAM_END) {
+            break;
+        }
+
+        compressed.resize(compressed.size() * 2);
+    }
+
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (result == Z_STREAM_ERROR || (last && result != Z_STREAM_END)) {
+        throw std::ios_base::failure("Deflate failed");
+    }
+
+    return compressed;
+}
+
+/// Compressed bytes read at once when inflating a stream.
+const size_t INFLATE_INPUT_SIZE = 1 << 20;
+
+/// Inflated bytes written at once to a stream.
+const size_t INFLATE_OUTPUT_SIZE = 4 << 20;
+
+/// Inflated bytes between progress reports.
+const size_t INFLATE_PROGRESS_INTERVAL = 16 << 20;
+
+//------------------------------------------------------------------------------
+/// Collects inflated data in a block that is written to a stream when full.
+//
+class StreamOutput
+{
+public:
+    explicit StreamOutput(std::ostream &sink) :
+        sink_(sink),
+        buffer_(INFLATE_OUTPUT_SIZE)
+    {
+    }
+
+    inline uint8_t *space(size_t &available)
+    {
+        if (used_ == buffer_.size()) {
+            flush();
+        }
+
+        available = buffer_.size() - used_;
+        return buffer_.data() + used_;
+    }
+
+    inline void commit(size_t size)
+    {
+        used_ += size;
+    }
+
+    void flush(void)
+    {
+        sink_.write(reinterpret_cast<const char *>(buffer_.data()), used_);
+        used_ = 0;
+
+        if (!sink_) {
+            throw std::ios_base::failure("Can't write inflated data");
+        }
+    }
+
+private:
+    std::ostream &sink_;
+    std::vector<uint8_t> buffer_;
+    size_t used_ = 0;
+};
+
+//------------------------------------------------------------------------------
+/// Inflates directly into a file mapping, which is doubled when full.
+//
+class MappedOutput
+{
+public:
+    MappedOutput(WritableMappedFile &file, size_t used) :
+        file_(file),
+        used_(used)
+    {
+    }
+
+    inline uint8_t *space(size_t &available)
+    {
+        if (used_ == file_.size()) {
+            file_.resize(file_.size() * 2);
+        }
+
+        available = file_.size() - used_;
+        return file_.data() + used_;
+    }
+
+    inline void commit(size_t size)
+    {
+        used_ += size;
+    }
+
+    inline size_t used(void) const
+    {
+        return used_;
+    }
+
+private:
+    WritableMappedFile &file_;
+    size_t used_;
+};
+
+//------------------------------------------------------------------------------
+/// Inflates the rest of source into output. Memory buffers are inflated from
+/// where they are, other streams are read in large blocks.
+//
+template <typename Output>
+void inflateStream(std::istream &source, Output &output, const DecompressProgressCallback &progress)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    MemoryStreamBuf *sourceBuf = dynamic_cast<MemoryStreamBuf *>(source.rdbuf());
+    std::vector<uint8_t> input(sourceBuf ? 0 : INFLATE_INPUT_SIZE);
+
+    z_stream stream{};
+
+    // Important thing here is window_bits = 15
+    if (inflateInit2(&stream, -15) != Z_OK) {
+        throw std::ios_base::failure("Failed to initialize inflate");
+    }
+
+    DecompressProgress state;
+    uint64_t nextReport = INFLATE_PROGRESS_INTERVAL;
+
+    const auto report = [&](bool finished) {
+        state.compressedBytes = stream.total_in;
+        state.decompressedBytes = stream.total_out;
+        state.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        state.finished = finished;
+        progress(state);
+    };
+
+    int result = Z_OK;
+    bool sourceDone = false;
+
+    try {
+        while (result != Z_STREAM_END) {
+            if (stream.avail_in == 0 && !sourceDone) {
+                if (sourceBuf) {
+                    const size_t size = std::min<size_t>(sourceBuf->remaining(), UINT_MAX);
+                    stream.next_in = const_cast<uint8_t *>(sourceBuf->current());
+                    stream.avail_in = size;
+                    sourceBuf->skip(size);
+                } else {
+                    source.read(reinterpret_cast<char *>(input.data()), input.size());
+                    stream.next_in = input.data();
+                    stream.avail_in = source.gcount();
+                }
+
+                sourceDone = stream.avail_in == 0;
+            }
+
+            size_t available = 0;
+            stream.next_out = output.space(available);
+            stream.avail_out = std::min<size_t>(available, UINT_MAX);
+
+            const size_t before = stream.avail_out;
+            result = inflate(&stream, Z_NO_FLUSH);
+            output.commit(before - stream.avail_out);
+
+            if (result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_MEM_ERROR ||
+                    (result == Z_BUF_ERROR && sourceDone)) {
+                const std::string message = stream.msg ? stream.msg : "truncated data";
+                throw std::ios_base::failure("Zlib decompression failed: " + message);
+            }
+
+            if (progress && stream.total_out >= nextReport) {
+                report(false);
+                nextReport = stream.total_out + INFLATE_PROGRESS_INTERVAL;
+            }
+        }
+    } catch (...) {
+        inflateEnd(&stream);
+        throw;
+    }
+
+    // Data after the compressed stream is left in the buffer.
+    if (sourceBuf) {
+        sourceBuf->pubseekoff(-std::streamoff(stream.avail_in), std::ios::cur, std::ios::in);
+    }
+
+    if (progress) {
+        report(true);
+    }
+
+    inflateEnd(&stream);
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 Compressor::Compressor(ISerializable *obj) :
     obj_(obj)
@@ -44,7 +296,10 @@ void Compressor::beginCompression(void)
         break;
 
     case ISerializable::OP_WRITE:
-        obj_->setIStream(*istream_);
+        if (istream_) {
+            obj_->setIStream(*istream_);
+        }
+
         ostream_ = obj_->getOStream();
 
         startCompression();
@@ -75,23 +330,102 @@ void Compressor::endCompression(void)
 }
 
 //------------------------------------------------------------------------------
-void Compressor::decompress(std::istream &source, std::ostream &sink)
+void Compressor::setDecompressToMemory(bool inMemory)
+{
+    decompressToMemory_ = inMemory;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> Compressor::takeDecompressedData(void)
+{
+    return std::move(decompressed_);
+}
+
+//------------------------------------------------------------------------------
+void Compressor::setCompressionLevel(int level)
+{
+    compressionLevel_ = std::clamp(level, -1, 9);
+}
+
+//------------------------------------------------------------------------------
+int Compressor::getCompressionLevel(void) const
 {
-    Compressor cmp;
+    return compressionLevel_;
+}
+
+//------------------------------------------------------------------------------
+void Compressor::setThreadPool(ThreadPool *pool)
+{
+    threadPool_ = pool;
+}
+
+//------------------------------------------------------------------------------
+void Compressor::decompress(std::istream &source, std::ostream &sink,
+                            const DecompressProgressCallback &progress)
+{
+    StreamOutput output(sink);
+    inflateStream(source, output, progress);
+    output.flush();
+}
+
+//------------------------------------------------------------------------------
+void Compressor::decompress(std::istream &source, const std::string &fileName,
+                            const DecompressOptions &options, const std::string &header)
+{
+    if (!options.mapOutput) {
+        std::ofstream file(fileName, std::ios::binary);
+
+        if (file.fail()) {
+            throw std::ios_base::failure("Can't write to file: \"" + fileName + "\"");
+        }
+
+        file.write(header.data(), header.size());
+        decompress(source, file, options.progress);
+        return;
+    }
+
+    // Genie files inflate to around five times their size, which is a good
+    // start for the mapping if the size of the source is known.
+    size_t size = INFLATE_OUTPUT_SIZE;
+    const std::streampos position = source.tellg();
 
-    cmp.istream_ = &source;
-    cmp.startDecompression();
+    if (position != std::streampos(-1)) {
+        source.seekg(0, std::ios::end);
+        const std::streampos end = source.tellg();
+        source.seekg(position);
 
-    while (!cmp.uncompressedIstream_->eof() && sink.good()) {
-        char buffer[4096];
-        source.get(buffer, sizeof buffer);
-        sink.write(buffer, source.gcount());
+        if (end > position) {
+            size = std::max<size_t>(size, size_t(end - position) * 5);
+        }
     }
+
+    WritableMappedFile file;
+    file.open(fileName, header.size() + size);
+    memcpy(file.data(), header.data(), header.size());
+
+    MappedOutput output(file, header.size());
+
+    try {
+        inflateStream(source, output, options.progress);
+    } catch (...) {
+        file.close(output.used());
+        throw;
+    }
+
+    file.close(output.used());
 }
 
 //------------------------------------------------------------------------------
 void Compressor::startDecompression(void)
 {
+    if (decompressToMemory_) {
+        inflateToMemory();
+
+        decompressedBuf_.setBuffer(decompressed_.data(), decompressed_.size());
+        uncompressedIstream_ = std::make_shared<std::istream>(&decompressedBuf_);
+        return;
+    }
+
     try {
         // Important thing here is window_bits = 15
         uncompressedIstream_ = std::make_shared<zstr::istream>(*istream_, (std::size_t)1 << 20, false, -15);
@@ -102,6 +436,100 @@ void Compressor::startDecompression(void)
     }
 }
 
+//------------------------------------------------------------------------------
+void Compressor::inflateToMemory(void)
+{
+    // Files loaded into memory are inflated from where they are, others are
+    // read completely first.
+    MemoryStreamBuf *sourceBuf = dynamic_cast<MemoryStreamBuf *>(istream_->rdbuf());
+    std::vector<uint8_t> sourceData;
+    const uint8_t *source = nullptr;
+    size_t sourceSize = 0;
+
+    if (sourceBuf) {
+        source = sourceBuf->current();
+        sourceSize = sourceBuf->remaining();
+    } else {
+        const std::streampos start = istream_->tellg();
+        istream_->seekg(0, std::ios::end);
+        const std::streampos end = istream_->tellg();
+        istream_->seekg(start);
+
+        if (start != std::streampos(-1) && end > start) {
+            sourceData.resize(size_t(end - start));
+        }
+
+        // Streams that can't seek are read in growing steps.
+        size_t used = 0;
+
+        for (;;) {
+            if (used == sourceData.size()) {
+                sourceData.resize(std::max<size_t>(sourceData.size() * 2, 1 << 20));
+            }
+
+            istream_->read(reinterpret_cast<char *>(sourceData.data() + used), sourceData.size() - used);
+            used += istream_->gcount();
+
+            if (!*istream_) {
+                break;
+            }
+        }
+
+        istream_->clear();
+        sourceData.resize(used);
+
+        source = sourceData.data();
+        sourceSize = sourceData.size();
+    }
+
+    z_stream stream{};
+
+    // Important thing here is window_bits = 15
+    if (inflateInit2(&stream, -15) != Z_OK) {
+        throw std::ios_base::failure("Failed to initialize inflate");
+    }
+
+    // The inflated size isn't stored anywhere. Genie files inflate to around
+    // five times their size, the buffer is doubled if that's not enough.
+    decompressed_.resize(std::max<size_t>(sourceSize * 5, 1 << 20));
+
+    stream.next_in = const_cast<uint8_t *>(source);
+    stream.avail_in = sourceSize;
+
+    int result = Z_OK;
+
+    for (;;) {
+        const size_t used = stream.total_out;
+        stream.next_out = decompressed_.data() + used;
+        stream.avail_out = decompressed_.size() - used;
+
+        result = inflate(&stream, Z_FINISH);
+
+        if (result == Z_STREAM_END || stream.avail_out > 0) {
+            break;
+        }
+
+        decompressed_.resize(decompressed_.size() * 2);
+    }
+
+    decompressed_.resize(stream.total_out);
+
+    const size_t consumed = stream.total_in;
+    const std::string message = stream.msg ? stream.msg : "truncated data";
+    inflateEnd(&stream);
+
+    // Like when streaming, data after a broken or truncated stream is just
+    // missing and fails the reads.
+    if (result != Z_STREAM_END) {
+        std::cerr << "Zlib decompression failed with error code: "
+                  << message << std::endl;
+    }
+
+    if (sourceBuf) {
+        sourceBuf->skip(consumed);
+    }
+}
+
 //------------------------------------------------------------------------------
 void Compressor::stopDecompression(void)
 {
@@ -109,14 +537,23 @@ void Compressor::stopDecompression(void)
     istream_ = 0;
 
     uncompressedIstream_.reset();
+
+    decompressedBuf_.setBuffer(nullptr, 0);
+    std::vector<uint8_t>().swap(decompressed_);
 }
 
 //------------------------------------------------------------------------------
 void Compressor::startCompression(void)
 {
+    if (threadPool_) {
+        writeBuffer_ = std::make_unique<VectorStreamBuf>(written_);
+        bufferedStream_ = std::make_shared<std::ostream>(writeBuffer_.get());
+        return;
+    }
+
     try {
         // Important thing here is window_bits = 15
-        bufferedStream_ = std::make_shared<zstr::ostream>(*ostream_, (std::size_t)1 << 20, Z_DEFAULT_COMPRESSION, -15);
+        bufferedStream_ = std::make_shared<zstr::ostream>(*ostream_, (std::size_t)1 << 20, compressionLevel_, -15);
     } catch (const zstr::Exception &exception) {
         bufferedStream_.reset();
         std::cerr << "Zlib compression failed with error code: "
@@ -127,8 +564,72 @@ void Compressor::startCompression(void)
 //------------------------------------------------------------------------------
 void Compressor::stopCompression(void)
 {
+    std::exception_ptr error;
+
+    if (writeBuffer_) {
+        try {
+            compressParallel();
+        } catch (...) {
+            // The file would be cut off, the caller needs to know.
+            error = std::current_exception();
+        }
+
+        writeBuffer_.reset();
+        std::vector<uint8_t>().swap(written_);
+    }
+
     ostream_ = 0;
     bufferedStream_.reset();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Compressor::compressParallel(void)
+{
+    const std::vector<uint8_t> &data = written_;
+    std::vector<std::future<std::vector<uint8_t>>> chunks;
+
+    // Even empty data needs a final block.
+    for (size_t offset = 0; offset < data.size() || chunks.empty(); offset += COMPRESSION_CHUNK_SIZE) {
+        const size_t size = std::min(COMPRESSION_CHUNK_SIZE, data.size() - offset);
+        const size_t dictionarySize = std::min(COMPRESSION_DICTIONARY_SIZE, offset);
+        const bool last = offset + size >= data.size();
+        const uint8_t *chunk = data.data() + offset;
+        const int level = compressionLevel_;
+
+        chunks.push_back(threadPool_->submit([=]() {
+            return deflateChunk(chunk, size, chunk - dictionarySize, dictionarySize, level, last);
+        }));
+    }
+
+    std::exception_ptr error;
+
+    // Written in order as soon as each chunk is done, helping out instead
+    // of just waiting.
+    for (std::future<std::vector<uint8_t>> &chunk : chunks) {
+        while (chunk.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+               threadPool_->runPendingTask()) {
+        }
+
+        try {
+            const std::vector<uint8_t> compressed = chunk.get();
+
+            if (!error) {
+                ostream_->write(reinterpret_cast<const char *>(compressed.data()), compressed.size());
+            }
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 } // namespace genie
 
@@ -22,6 +22,12 @@
 
 namespace genie {
 
+//------------------------------------------------------------------------------
+IFile::IFile() :
+    mappedIn_(&mappedBuf_)
+{
+}
+
 //------------------------------------------------------------------------------
 IFile::~IFile()
 {
@@ -32,6 +38,21 @@ IFile::~IFile()
 void IFile::freelock()
 {
     fileIn_.close();
+
+    mappedBuf_.setBuffer(nullptr, 0);
+    mappedFile_.close();
+}
+
+//------------------------------------------------------------------------------
+void IFile::setLoadMode(LoadMode mode)
+{
+    loadMode_ = mode;
+}
+
+//------------------------------------------------------------------------------
+IFile::LoadMode IFile::getLoadMode(void) const
+{
+    return loadMode_;
 }
 
 //------------------------------------------------------------------------------
@@ -63,6 +84,16 @@ void IFile::load(const std::string &fileName)
 
     fileName_ = fileName;
 
+    if (loadMode_ == LOAD_MAPPED) {
+        mappedFile_.open(fileName);
+        mappedBuf_.setBuffer(mappedFile_.data(), mappedFile_.size());
+        mappedIn_.clear();
+
+        readObject(inputStream(mappedIn_));
+        loaded_ = true;
+        return;
+    }
+
     fileIn_.open(fileName, std::ios::binary | std::ios::in);
 
     if (fileIn_.fail()) {
@@ -70,7 +101,7 @@ void IFile::load(const std::string &fileName)
         std::string errnoString(strerror(errno));
         throw std::ios_base::failure("Can't read file \"" + fileName_ + "\": " + errnoString);
     } else {
-        readObject(fileIn_);
+        readObject(inputStream(fileIn_));
         loaded_ = true;
     }
 }
@@ -102,6 +133,28 @@ void IFile::saveAs(const char *fileName)
     file.close();
 }
 
+//------------------------------------------------------------------------------
+ByteSpan IFile::getMappedData(void) const
+{
+    if (!mappedFile_.isOpen()) {
+        return ByteSpan();
+    }
+
+    return ByteSpan(mappedFile_.data(), mappedFile_.size());
+}
+
+//------------------------------------------------------------------------------
+std::istream &IFile::inputStream(std::istream &source)
+{
+    if (!IoStats::isEnabled()) {
+        return source;
+    }
+
+    instrumentedIn_ = std::make_unique<InstrumentedIStream>(source.rdbuf());
+
+    return *instrumentedIn_;
+}
+
 //------------------------------------------------------------------------------
 void IFile::unload()
 {
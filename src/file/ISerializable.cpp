@@ -21,16 +21,35 @@
 #include "genie/file/ISerializable.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace genie {
 
+//------------------------------------------------------------------------------
+ISerializable::ISerializable(const ISerializable &other) noexcept :
+    init_read_pos_(other.init_read_pos_),
+    gameVersion_(other.gameVersion_)
+{
+}
+
+//------------------------------------------------------------------------------
+ISerializable &ISerializable::operator=(const ISerializable &other) noexcept
+{
+    init_read_pos_ = other.init_read_pos_;
+    gameVersion_ = other.gameVersion_;
+
+    return *this;
+}
+
 //------------------------------------------------------------------------------
 void ISerializable::readObject(std::istream &istr)
 {
     setOperation(OP_READ);
-    istr_ = &istr;
+    setIStream(istr);
+    state_->context = ownContext();
+    state_->skipping = false;
 
-    istr_->seekg(init_read_pos_);
+    istr.seekg(std::streampos(init_read_pos_));
 
     serializeObject();
 }
@@ -39,29 +58,60 @@ void ISerializable::readObject(std::istream &istr)
 void ISerializable::writeObject(std::ostream &ostr)
 {
     setOperation(OP_WRITE);
-    ostr_ = &ostr;
+    setOStream(ostr);
+    state_->context = ownContext();
     serializeObject();
 }
 
 //------------------------------------------------------------------------------
 size_t ISerializable::objectSize(void)
 {
-    size_ = 0;
+    State &state = ownState();
+    state.size = 0;
+    state.operation = OP_CALC_SIZE;
+    state.context = ownContext();
 
-    setOperation(OP_CALC_SIZE);
     serializeObject();
 
-    return size_;
+    return state.size;
+}
+
+//------------------------------------------------------------------------------
+SerializationContext &ISerializable::context(void)
+{
+    if (state_ && state_->context) {
+        return *state_->context;
+    }
+
+    if (SerializationContext *own = ownContext()) {
+        return *own;
+    }
+
+    static thread_local SerializationContext threadContext;
+    return threadContext;
+}
+
+//------------------------------------------------------------------------------
+ISerializable::State &ISerializable::ownState(void)
+{
+    if (!ownState_) {
+        ownState_ = std::make_unique<State>();
+    }
+
+    // Continues with the streams of the serialization this object is part of.
+    if (state_ && state_ != ownState_.get()) {
+        *ownState_ = *state_;
+    }
+
+    state_ = ownState_.get();
+
+    return *state_;
 }
 
 //------------------------------------------------------------------------------
 void ISerializable::serializeSubObject(ISerializable *const other)
 {
-    istr_ = other->istr_;
-    ostr_ = other->ostr_;
-    operation_ = other->operation_;
-    setGameVersion(other->gameVersion_);
-    serializeObject();
+    other->serializeSub(*this);
 }
 
 //------------------------------------------------------------------------------
@@ -86,7 +136,7 @@ size_t ISerializable::strnlen(const char *str, size_t maxLen)
 std::streampos ISerializable::tellg(void) const
 {
     if (isOperation(OP_READ)) {
-        return istr_->tellg();
+        return state_->istr->tellg();
     }
 
     return 0;
@@ -95,7 +145,20 @@ std::streampos ISerializable::tellg(void) const
 //------------------------------------------------------------------------------
 std::string ISerializable::readString(size_t len)
 {
-    if (len > 0 && !istr_->eof()) {
+    // Construct the string directly from the buffer, no need for a copy.
+    if (state_->membuf && len > 0) {
+        MemoryStreamBuf *membuf = state_->membuf;
+        const char *str = reinterpret_cast<const char *>(membuf->current());
+        const size_t available = std::min(len, membuf->remaining());
+
+        if (!membuf->skip(len)) {
+            state_->istr->setstate(std::ios::eofbit | std::ios::failbit);
+        }
+
+        return std::string(str, ISerializable::strnlen(str, available));
+    }
+
+    if (len > 0 && !state_->istr->eof()) {
         char *buf = nullptr;
         serialize<char>(&buf, len);
 
@@ -125,7 +188,7 @@ void ISerializable::writeString(const std::string &str, size_t len)
         buf[i] = 0; // fill up with 0
     }
 
-    ostr_->write(buf, len);
+    state_->ostr->write(buf, len);
 
     delete[] buf;
 }
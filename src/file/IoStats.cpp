@@ -0,0 +1,226 @@
+/*
+    Read and seek counters per resource type
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/file/IoStats.h"
+
+#include <atomic>
+
+namespace genie {
+
+namespace {
+
+struct AtomicCounters {
+    std::atomic<uint64_t> readCalls{ 0 };
+    std::atomic<uint64_t> bytesRead{ 0 };
+    std::atomic<uint64_t> seeks{ 0 };
+    std::atomic<uint64_t> seekDistance{ 0 };
+};
+
+std::atomic<bool> enabled{ false };
+std::array<AtomicCounters, IoStats::IO_RESOURCE_COUNT> counters;
+
+thread_local IoStats::Resource currentResource = IoStats::IO_OTHER;
+
+} // namespace
+
+//------------------------------------------------------------------------------
+IoStats::Scope::Scope(Resource resource) :
+    previous_(currentResource)
+{
+    currentResource = resource;
+}
+
+//------------------------------------------------------------------------------
+IoStats::Scope::~Scope()
+{
+    currentResource = previous_;
+}
+
+//------------------------------------------------------------------------------
+void IoStats::setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bool IoStats::isEnabled(void)
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+IoStats::Snapshot IoStats::snapshot(void)
+{
+    Snapshot snapshot;
+
+    for (size_t i = 0; i < IO_RESOURCE_COUNT; i++) {
+        snapshot[i].readCalls = counters[i].readCalls.load(std::memory_order_relaxed);
+        snapshot[i].bytesRead = counters[i].bytesRead.load(std::memory_order_relaxed);
+        snapshot[i].seeks = counters[i].seeks.load(std::memory_order_relaxed);
+        snapshot[i].seekDistance = counters[i].seekDistance.load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------
+void IoStats::reset(void)
+{
+    for (AtomicCounters &resource : counters) {
+        resource.readCalls.store(0, std::memory_order_relaxed);
+        resource.bytesRead.store(0, std::memory_order_relaxed);
+        resource.seeks.store(0, std::memory_order_relaxed);
+        resource.seekDistance.store(0, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------
+const char *IoStats::getResourceName(Resource resource)
+{
+    static const char *const names[IO_RESOURCE_COUNT] = {
+        "other",
+        "dat",
+        "drs",
+        "slp",
+        "smp",
+        "smx",
+        "palette",
+        "edge",
+        "slp_template"
+    };
+
+    return resource < IO_RESOURCE_COUNT ? names[resource] : "";
+}
+
+//------------------------------------------------------------------------------
+void IoStats::countRead(uint64_t bytes)
+{
+    AtomicCounters &resource = counters[currentResource];
+    resource.readCalls.fetch_add(1, std::memory_order_relaxed);
+    resource.bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void IoStats::countSeek(uint64_t distance)
+{
+    AtomicCounters &resource = counters[currentResource];
+    resource.seeks.fetch_add(1, std::memory_order_relaxed);
+    resource.seekDistance.fetch_add(distance, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::InstrumentedStreamBuf(std::streambuf &target) :
+    target_(target),
+    position_(target.pubseekoff(0, std::ios_base::cur, std::ios_base::in))
+{
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::int_type InstrumentedStreamBuf::underflow()
+{
+    // Only peeks, nothing is read until uflow().
+    return target_.sgetc();
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::int_type InstrumentedStreamBuf::uflow()
+{
+    const int_type c = target_.sbumpc();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        IoStats::countRead(1);
+
+        if (position_ >= 0) {
+            position_++;
+        }
+    }
+
+    return c;
+}
+
+//------------------------------------------------------------------------------
+std::streamsize InstrumentedStreamBuf::xsgetn(char *s, std::streamsize n)
+{
+    const std::streamsize count = target_.sgetn(s, n);
+    IoStats::countRead(count);
+
+    if (position_ >= 0) {
+        position_ += count;
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+std::streamsize InstrumentedStreamBuf::showmanyc()
+{
+    return target_.in_avail();
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::pos_type InstrumentedStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                               std::ios_base::openmode which)
+{
+    const pos_type position = target_.pubseekoff(off, dir, which);
+
+    // tellg() seeks by 0 from the current position.
+    if (off == 0 && dir == std::ios_base::cur) {
+        position_ = off_type(position);
+        return position;
+    }
+
+    return seeked(position);
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::pos_type InstrumentedStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seeked(target_.pubseekpos(pos, which));
+}
+
+//------------------------------------------------------------------------------
+InstrumentedStreamBuf::pos_type InstrumentedStreamBuf::seeked(pos_type position)
+{
+    const off_type target = off_type(position);
+    uint64_t distance = 0;
+
+    if (target >= 0 && position_ >= 0) {
+        if (target == position_) {
+            return position;
+        }
+
+        distance = target > position_ ? target - position_ : position_ - target;
+    }
+
+    IoStats::countSeek(distance);
+    position_ = target;
+
+    return position;
+}
+
+//------------------------------------------------------------------------------
+InstrumentedIStream::InstrumentedIStream(std::streambuf *target) :
+    std::istream(target)
+{
+    if (target && IoStats::isEnabled()) {
+        instrumented_ = std::make_unique<InstrumentedStreamBuf>(*target);
+        rdbuf(instrumented_.get());
+    }
+}
+
+} // namespace genie
@@ -0,0 +1,325 @@
+/*
+    Read-only memory mapping of a whole file
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/file/MappedFile.h"
+
+#include <algorithm>
+#include <iostream>
+#include <ios>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+//------------------------------------------------------------------------------
+void MappedFile::open(const std::string &fileName)
+{
+    close();
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::ios_base::failure("Can't open file \"" + fileName + "\" for mapping");
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::ios_base::failure("Can't get size of file \"" + fileName + "\"");
+    }
+
+    fileHandle_ = file;
+    size_ = size_t(fileSize.QuadPart);
+    open_ = true;
+
+    // Empty files can't be mapped, but are valid nonetheless.
+    if (size_ == 0) {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!mapping) {
+        close();
+        throw std::ios_base::failure("Can't map file \"" + fileName + "\"");
+    }
+
+    mappingHandle_ = mapping;
+    data_ = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!data_) {
+        close();
+        throw std::ios_base::failure("Can't map view of file \"" + fileName + "\"");
+    }
+}
+
+//------------------------------------------------------------------------------
+void MappedFile::close()
+{
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+
+    if (mappingHandle_) {
+        CloseHandle(mappingHandle_);
+    }
+
+    if (fileHandle_) {
+        CloseHandle(fileHandle_);
+    }
+
+    data_ = nullptr;
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::open(const std::string &fileName, size_t size)
+{
+    close(0);
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::ios_base::failure("Can't write to file: \"" + fileName + "\"");
+    }
+
+    fileName_ = fileName;
+    fileHandle_ = file;
+    open_ = true;
+
+    resize(size);
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::map(void)
+{
+    // Mapping more than the file has grows it.
+    HANDLE mapping = CreateFileMappingA(fileHandle_, nullptr, PAGE_READWRITE,
+                                        DWORD(uint64_t(size_) >> 32), DWORD(size_), nullptr);
+
+    if (!mapping) {
+        throw std::ios_base::failure("Can't map file \"" + fileName_ + "\"");
+    }
+
+    mappingHandle_ = mapping;
+    data_ = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0));
+
+    if (!data_) {
+        throw std::ios_base::failure("Can't map view of file \"" + fileName_ + "\"");
+    }
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::unmap(void)
+{
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+
+    if (mappingHandle_) {
+        CloseHandle(mappingHandle_);
+    }
+
+    data_ = nullptr;
+    mappingHandle_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::close(size_t usedSize)
+{
+    unmap();
+
+    if (fileHandle_) {
+        LARGE_INTEGER end;
+        end.QuadPart = LONGLONG(usedSize);
+
+        SetFilePointerEx(fileHandle_, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(fileHandle_);
+        CloseHandle(fileHandle_);
+    }
+
+    fileHandle_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+#else
+//------------------------------------------------------------------------------
+void MappedFile::open(const std::string &fileName)
+{
+    close();
+
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        std::string errnoString(strerror(errno));
+        throw std::ios_base::failure("Can't read file \"" + fileName + "\": " + errnoString);
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0) {
+        std::string errnoString(strerror(errno));
+        ::close(fd);
+        throw std::ios_base::failure("Can't stat file \"" + fileName + "\": " + errnoString);
+    }
+
+    size_ = size_t(st.st_size);
+    open_ = true;
+
+    // Empty files can't be mapped, but are valid nonetheless.
+    if (size_ == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        std::string errnoString(strerror(errno));
+        size_ = 0;
+        open_ = false;
+        throw std::ios_base::failure("Can't map file \"" + fileName + "\": " + errnoString);
+    }
+
+#ifdef MADV_SEQUENTIAL
+    // Files are mostly parsed front to back.
+    madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+
+    data_ = static_cast<const uint8_t *>(data);
+}
+
+//------------------------------------------------------------------------------
+void MappedFile::close()
+{
+    if (data_) {
+        munmap(const_cast<uint8_t *>(data_), size_);
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::open(const std::string &fileName, size_t size)
+{
+    close(0);
+
+    fd_ = ::open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd_ < 0) {
+        std::string errnoString(strerror(errno));
+        throw std::ios_base::failure("Can't write to file: \"" + fileName + "\": " + errnoString);
+    }
+
+    fileName_ = fileName;
+    open_ = true;
+
+    resize(size);
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::map(void)
+{
+    if (ftruncate(fd_, off_t(size_)) != 0) {
+        std::string errnoString(strerror(errno));
+        throw std::ios_base::failure("Can't grow file \"" + fileName_ + "\": " + errnoString);
+    }
+
+    void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+    if (data == MAP_FAILED) {
+        std::string errnoString(strerror(errno));
+        throw std::ios_base::failure("Can't map file \"" + fileName_ + "\": " + errnoString);
+    }
+
+    data_ = static_cast<uint8_t *>(data);
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::unmap(void)
+{
+    if (data_) {
+        munmap(data_, size_);
+    }
+
+    data_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::close(size_t usedSize)
+{
+    unmap();
+
+    if (fd_ >= 0) {
+        if (ftruncate(fd_, off_t(usedSize)) != 0) {
+            std::cerr << "Can't cut file \"" << fileName_ << "\": " << strerror(errno) << std::endl;
+        }
+
+        ::close(fd_);
+    }
+
+    fd_ = -1;
+    size_ = 0;
+    open_ = false;
+}
+#endif
+
+//------------------------------------------------------------------------------
+WritableMappedFile::~WritableMappedFile()
+{
+    close(size_);
+}
+
+//------------------------------------------------------------------------------
+void WritableMappedFile::resize(size_t size)
+{
+    unmap();
+
+    // Empty mappings aren't allowed.
+    size_ = std::max<size_t>(size, 1);
+    map();
+}
+} // namespace genie
@@ -0,0 +1,100 @@
+/*
+    Stream buffer and byte cursor over a block of memory
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/file/MemoryStreamBuf.h"
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+MemoryStreamBuf::MemoryStreamBuf(const uint8_t *data, size_t size)
+{
+    setBuffer(data, size);
+}
+
+//------------------------------------------------------------------------------
+void MemoryStreamBuf::setBuffer(const uint8_t *data, size_t size)
+{
+    // The buffer is never written to, istream only needs non-const pointers.
+    char *start = const_cast<char *>(reinterpret_cast<const char *>(data));
+    setg(start, start, start + size);
+}
+
+//------------------------------------------------------------------------------
+std::streamsize MemoryStreamBuf::xsgetn(char *s, std::streamsize n)
+{
+    if (n <= 0) {
+        return 0;
+    }
+
+    const size_t count = std::min(size_t(n), remaining());
+    memcpy(s, gptr(), count);
+    advance(count);
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+std::streamsize MemoryStreamBuf::showmanyc()
+{
+    return remaining() ? std::streamsize(remaining()) : -1;
+}
+
+//------------------------------------------------------------------------------
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                   std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+
+    switch (dir) {
+    case std::ios_base::beg:
+        base = 0;
+        break;
+
+    case std::ios_base::cur:
+        base = gptr() - eback();
+        break;
+
+    case std::ios_base::end:
+        base = egptr() - eback();
+        break;
+
+    default:
+        return pos_type(off_type(-1));
+    }
+
+    const off_type target = base + off;
+
+    if (target < 0 || target > off_type(size())) {
+        return pos_type(off_type(-1));
+    }
+
+    setg(eback(), eback() + target, egptr());
+
+    return pos_type(target);
+}
+
+//------------------------------------------------------------------------------
+MemoryStreamBuf::pos_type MemoryStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+} // namespace genie
@@ -0,0 +1,302 @@
+/*
+    File that is read at explicit offsets
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/file/PositionalFile.h"
+
+#include <algorithm>
+#include <ios>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace genie {
+
+namespace {
+
+/// Big enough for the tables and headers read in small pieces, bigger reads
+/// go directly to the file.
+const size_t BUFFER_SIZE = 16 * 1024;
+
+} // namespace
+
+//------------------------------------------------------------------------------
+PositionalFile::~PositionalFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+//------------------------------------------------------------------------------
+void PositionalFile::open(const std::string &fileName)
+{
+    close();
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::ios_base::failure("Can't read file \"" + fileName + "\"");
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::ios_base::failure("Can't get size of file \"" + fileName + "\"");
+    }
+
+    fileHandle_ = file;
+    size_ = uint64_t(fileSize.QuadPart);
+    open_ = true;
+}
+
+//------------------------------------------------------------------------------
+void PositionalFile::close()
+{
+    if (fileHandle_) {
+        CloseHandle(fileHandle_);
+    }
+
+    fileHandle_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+//------------------------------------------------------------------------------
+size_t PositionalFile::readAt(uint64_t offset, void *dest, size_t size) const
+{
+    char *out = static_cast<char *>(dest);
+    size_t done = 0;
+
+    while (done < size) {
+        // The offset in the OVERLAPPED structure doesn't move the file
+        // pointer other threads might use.
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = DWORD(offset + done);
+        overlapped.OffsetHigh = DWORD((offset + done) >> 32);
+
+        const DWORD chunk = DWORD(std::min<size_t>(size - done, 0x40000000));
+        DWORD count = 0;
+
+        if (!ReadFile(fileHandle_, out + done, chunk, &count, &overlapped) || count == 0) {
+            break;
+        }
+
+        done += count;
+    }
+
+    return done;
+}
+
+#else
+//------------------------------------------------------------------------------
+void PositionalFile::open(const std::string &fileName)
+{
+    close();
+
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw std::ios_base::failure("Can't read file \"" + fileName + "\": " + strerror(errno));
+    }
+
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        throw std::ios_base::failure("Can't get size of file \"" + fileName + "\"");
+    }
+
+    fd_ = fd;
+    size_ = uint64_t(fileStat.st_size);
+    open_ = true;
+}
+
+//------------------------------------------------------------------------------
+void PositionalFile::close()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+
+    fd_ = -1;
+    size_ = 0;
+    open_ = false;
+}
+
+//------------------------------------------------------------------------------
+size_t PositionalFile::readAt(uint64_t offset, void *dest, size_t size) const
+{
+    char *out = static_cast<char *>(dest);
+    size_t done = 0;
+
+    while (done < size) {
+        const ssize_t count = pread(fd_, out + done, size - done, off_t(offset + done));
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            break;
+        }
+
+        done += size_t(count);
+    }
+
+    return done;
+}
+#endif
+
+//------------------------------------------------------------------------------
+PositionalStreamBuf::PositionalStreamBuf(const PositionalFile &file, uint64_t position) :
+    file_(file),
+    buffer_(BUFFER_SIZE),
+    bufferOffset_(position)
+{
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+//------------------------------------------------------------------------------
+PositionalStreamBuf::int_type PositionalStreamBuf::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    bufferOffset_ = position();
+
+    char *buffer = buffer_.data();
+    const size_t count = file_.readAt(bufferOffset_, buffer, buffer_.size());
+    setg(buffer, buffer, buffer + count);
+
+    if (count == 0) {
+        return traits_type::eof();
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+//------------------------------------------------------------------------------
+std::streamsize PositionalStreamBuf::xsgetn(char *s, std::streamsize n)
+{
+    std::streamsize done = 0;
+
+    while (done < n) {
+        const std::streamsize buffered = egptr() - gptr();
+
+        if (buffered > 0) {
+            const std::streamsize count = std::min(buffered, n - done);
+            memcpy(s + done, gptr(), size_t(count));
+            setg(eback(), gptr() + count, egptr());
+            done += count;
+            continue;
+        }
+
+        // Big reads skip the buffer, which is left empty after them.
+        if (size_t(n - done) >= buffer_.size()) {
+            const uint64_t start = position();
+            const size_t count = file_.readAt(start, s + done, size_t(n - done));
+
+            bufferOffset_ = start + count;
+            setg(buffer_.data(), buffer_.data(), buffer_.data());
+            done += std::streamsize(count);
+            break;
+        }
+
+        if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+            break;
+        }
+    }
+
+    return done;
+}
+
+//------------------------------------------------------------------------------
+std::streamsize PositionalStreamBuf::showmanyc()
+{
+    const uint64_t current = position();
+
+    if (current >= file_.size()) {
+        return -1;
+    }
+
+    return std::streamsize(file_.size() - current);
+}
+
+//------------------------------------------------------------------------------
+PositionalStreamBuf::pos_type PositionalStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                           std::ios_base::openmode which)
+{
+    if (!(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+
+    off_type base = 0;
+
+    switch (dir) {
+    case std::ios_base::beg:
+        base = 0;
+        break;
+
+    case std::ios_base::cur:
+        base = off_type(position());
+        break;
+
+    case std::ios_base::end:
+        base = off_type(file_.size());
+        break;
+
+    default:
+        return pos_type(off_type(-1));
+    }
+
+    const off_type target = base + off;
+
+    if (target < 0) {
+        return pos_type(off_type(-1));
+    }
+
+    // Seeking inside what is buffered doesn't read again.
+    const uint64_t position = uint64_t(target);
+
+    if (position >= bufferOffset_ && position <= bufferOffset_ + uint64_t(egptr() - eback())) {
+        setg(eback(), eback() + (position - bufferOffset_), egptr());
+    } else {
+        bufferOffset_ = position;
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+    }
+
+    return pos_type(target);
+}
+
+//------------------------------------------------------------------------------
+PositionalStreamBuf::pos_type PositionalStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+} // namespace genie
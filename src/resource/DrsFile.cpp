@@ -19,6 +19,7 @@
 
 #include "genie/resource/DrsFile.h"
 
+#include <algorithm>
 #include <string>
 
 #include "genie/util/Logger.h"
@@ -32,64 +33,129 @@ using std::string;
 
 Logger &DrsFile::log = Logger::getLogger("freeaoe.DrsFile");
 
+//------------------------------------------------------------------------------
+void DrsFile::load(const std::string &fileName)
+{
+    positional_file_.close();
+
+    IFile::load(fileName);
+
+    if (getLoadMode() != LOAD_MAPPED) {
+        positional_file_.open(fileName);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename Function>
+auto DrsFile::withStream(uint32_t offset, Function function) -> decltype(function(std::declval<std::istream *>()))
+{
+    const ByteSpan mapped = getMappedData();
+
+    if (!mapped.empty()) {
+        MemoryStreamBuf buffer(mapped.data(), mapped.size());
+        buffer.skip(offset);
+        InstrumentedIStream istr(&buffer);
+        return function(&istr);
+    }
+
+    if (positional_file_.isOpen()) {
+        PositionalStreamBuf buffer(positional_file_, offset);
+        InstrumentedIStream istr(&buffer);
+        return function(&istr);
+    }
+
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    getIStream()->clear();
+    getIStream()->seekg(std::streampos(offset));
+    return function(getIStream());
+}
+
 //------------------------------------------------------------------------------
 SlpFilePtr DrsFile::getSlpFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, SlpFilePtr>::iterator i = slp_map_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
+    const Entry *entry = findEntry(id, ENTRY_SLP);
 
-    if (i != slp_map_.end()) {
+    if (entry) {
 #ifndef NDEBUG
         log.debug("Loading SLP file [%u]", id);
 #endif
-        i->second->readObject(*getIStream());
-        return i->second;
-    } else {
-        std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+        std::lock_guard<std::mutex> lock(slp_mutexes_[id % slp_mutexes_.size()]);
+
+        SlpFilePtr &slp = slp_files_[entry - entries_.data()];
+
+        if (!slp) {
+            slp = std::make_shared<SlpFile>(entry->size);
+            slp->setInitialReadPosition(entry->offset);
+            slp->setLoadMode(getLoadMode());
+        }
+
+        withStream(entry->offset, [&](std::istream *istr) {
+            slp->readObject(*istr);
+        });
 
-        if (i != bina_map_.end()) {
+        return slp;
+    } else if ((entry = findEntry(id, ENTRY_BINA))) {
 #ifndef NDEBUG
-            log.debug("Loading SLP file [%u] from bina", id);
+        log.debug("Loading SLP file [%u] from bina", id);
 #endif
-            SlpFilePtr slp(new SlpFile(i->second->size()));
+        SlpFilePtr slp(new SlpFile(entry->size));
 
-            slp->setInitialReadPosition(i->second->getInitialReadPosition());
+        slp->setInitialReadPosition(entry->offset);
+        slp->setLoadMode(getLoadMode());
 
-            slp->readObject(*getIStream());
+        withStream(entry->offset, [&](std::istream *istr) {
+            slp->readObject(*istr);
+        });
 
-            return slp;
-        } else {
-            log.debug("No slp file with id [%u] found!", id);
-            return SlpFilePtr();
-        }
+        return slp;
+    } else {
+        log.debug("No slp file with id [%u] found!", id);
+        return SlpFilePtr();
     }
 }
 
 //------------------------------------------------------------------------------
 const PalFile &DrsFile::getPalFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, std::shared_ptr<PalFile>>::iterator i = pal_files_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
+    {
+        std::lock_guard<std::mutex> lock(pal_files_mutex_);
+        std::unordered_map<uint32_t, std::shared_ptr<PalFile>>::iterator i = pal_files_.find(id);
 
-    if (i != pal_files_.end()) {
-        return *i->second;
+        if (i != pal_files_.end()) {
+            return *i->second;
+        }
     }
 
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator b = bina_map_.find(id);
+    const Entry *entry = findEntry(id, ENTRY_BINA);
 
-    if (b == bina_map_.end()) {
+    if (!entry) {
         log.debug("No bina file with id [%u] found!", id);
         return PalFile::null;
     }
 
-    pal_files_[id] = b->second->readPalFile(getIStream());
-    return *pal_files_.find(id)->second;
+    // Read without the lock, if another thread was faster its palette is kept.
+    std::shared_ptr<PalFile> pal = withStream(entry->offset, [&](std::istream *istr) {
+        return binaFile(*entry).readPalFile(istr);
+    });
+
+    std::lock_guard<std::mutex> lock(pal_files_mutex_);
+    return *pal_files_.emplace(id, std::move(pal)).first->second;
 }
 
 UIFilePtr DrsFile::getUIFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
+    const Entry *entry = findEntry(id, ENTRY_BINA);
 
-    if (i != bina_map_.end()) {
-        return i->second->readUIFile(getIStream());
+    if (entry) {
+        return withStream(entry->offset, [&](std::istream *istr) {
+            return binaFile(*entry).readUIFile(istr);
+        });
     } else {
         log.debug("No bina file with id [%u] found!", id);
         return UIFilePtr();
@@ -131,10 +197,14 @@ UIFilePtr DrsFile::getUIFile(const std::string &knownName)
 
 BmpFilePtr DrsFile::getBmpFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
 
-    if (i != bina_map_.end()) {
-        return i->second->readBmpFile(getIStream());
+    const Entry *entry = findEntry(id, ENTRY_BINA);
+
+    if (entry) {
+        return withStream(entry->offset, [&](std::istream *istr) {
+            return binaFile(*entry).readBmpFile(istr);
+        });
     } else {
         log.debug("No bina file with id [%u] found!", id);
         return BmpFilePtr();
@@ -143,10 +213,14 @@ BmpFilePtr DrsFile::getBmpFile(uint32_t id)
 
 std::string DrsFile::getScriptFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
+    const Entry *entry = findEntry(id, ENTRY_BINA);
 
-    if (i != bina_map_.end()) {
-        return i->second->readScriptFile(getIStream());
+    if (entry) {
+        return withStream(entry->offset, [&](std::istream *istr) {
+            return binaFile(*entry).readScriptFile(istr);
+        });
     } else {
         log.debug("No bina file with id [%u] found!", id);
         return std::string();
@@ -155,10 +229,14 @@ std::string DrsFile::getScriptFile(uint32_t id)
 
 ScnFilePtr DrsFile::getScnFile(uint32_t id)
 {
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
+    const Entry *entry = findEntry(id, ENTRY_BINA);
 
-    if (i != bina_map_.end()) {
-        return i->second->readScnFile(getIStream());
+    if (entry) {
+        return withStream(entry->offset, [&](std::istream *istr) {
+            return binaFile(*entry).readScnFile(istr);
+        });
     } else {
         log.debug("No bina file with id [%u] found!", id);
         return ScnFilePtr();
@@ -167,61 +245,136 @@ ScnFilePtr DrsFile::getScnFile(uint32_t id)
 
 std::string DrsFile::idType(uint32_t id)
 {
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
     if (id >= 50000 && id < 50100) {
         return "screen data";
     }
 
-    if (wav_offsets_.find(id) != wav_offsets_.end()) {
+    if (findEntry(id, ENTRY_WAV)) {
         return "wav";
     }
 
-    if (slp_map_.find(id) != slp_map_.end()) {
+    if (findEntry(id, ENTRY_SLP)) {
         return "slp";
     }
 
-    std::unordered_map<uint32_t, BinaFilePtr>::iterator i = bina_map_.find(id);
+    const Entry *entry = findEntry(id, ENTRY_BINA);
 
-    if (i == bina_map_.end()) {
+    if (!entry) {
         return "unknown";
     }
 
-    return i->second->filetype(getIStream());
+    return withStream(entry->offset, [&](std::istream *istr) {
+        return binaFile(*entry).filetype(istr);
+    });
 }
 
 //------------------------------------------------------------------------------
 std::shared_ptr<uint8_t[]> DrsFile::getWavPtr(uint32_t id)
 {
-    std::unordered_map<uint32_t, uint32_t>::iterator i = wav_offsets_.find(id);
+    IoStats::Scope ioScope(IoStats::IO_DRS);
 
-    if (i != wav_offsets_.end()) {
-        getIStream()->seekg(std::streampos(i->second));
-        /*uint32_t type =*/ read<uint32_t>();
-        uint32_t size = read<uint32_t>();
+    const Entry *entry = findEntry(id, ENTRY_WAV);
 
-        if (!size)  {
-            return nullptr;
-        }
+    if (entry) {
+        return withStream(entry->offset, [&](std::istream *istr) -> std::shared_ptr<uint8_t[]> {
+            istr->seekg(std::streampos(entry->offset));
 
-#ifndef NDEBUG
-//        log.debug("WAV [%u], type [%X], size [%u]", id, type, size);
-#endif
-        getIStream()->seekg(std::streampos(i->second));
-        std::shared_ptr<uint8_t[]> ptr(new uint8_t[size + 32]);
-        uint8_t *data = ptr.get();
-        read(&data, size);
-        return ptr;
+            // RIFF chunk id and size
+            uint32_t header[2] = { 0, 0 };
+            istr->read(reinterpret_cast<char *>(header), sizeof(header));
+            const uint32_t size = header[1];
+
+            if (!size)  {
+                return nullptr;
+            }
+
+            istr->seekg(std::streampos(entry->offset));
+            std::shared_ptr<uint8_t[]> ptr(new uint8_t[size + 32]);
+            istr->read(reinterpret_cast<char *>(ptr.get()), size);
+            return ptr;
+        });
     } else {
         log.warn("No sound file with id [%u] found!", id);
         return nullptr;
     }
 }
 
+//------------------------------------------------------------------------------
+ByteSpan DrsFile::getSlpView(uint32_t id) const
+{
+    return getView(id, ENTRY_SLP);
+}
+
+//------------------------------------------------------------------------------
+ByteSpan DrsFile::getWavView(uint32_t id) const
+{
+    return getView(id, ENTRY_WAV);
+}
+
+//------------------------------------------------------------------------------
+ByteSpan DrsFile::getBinaView(uint32_t id) const
+{
+    return getView(id, ENTRY_BINA);
+}
+
+//------------------------------------------------------------------------------
+ByteSpan DrsFile::getBmpView(uint32_t id) const
+{
+    const ByteSpan view = getBinaView(id);
+
+    if (view.size() < 2 || view[0] != 'B' || view[1] != 'M') {
+        return ByteSpan();
+    }
+
+    return view;
+}
+
+//------------------------------------------------------------------------------
+ByteSpan DrsFile::getView(uint32_t id, EntryType type) const
+{
+    const Entry *entry = findEntry(id, type);
+
+    if (!entry) {
+        return ByteSpan();
+    }
+
+    return getMappedData().subspan(entry->offset, entry->size);
+}
+
+//------------------------------------------------------------------------------
+const DrsFile::Entry *DrsFile::findEntry(uint32_t id, EntryType type) const
+{
+    std::vector<Entry>::const_iterator i = std::lower_bound(entries_.begin(), entries_.end(), id,
+        [type](const Entry &entry, uint32_t id) {
+            return entry.id < id || (entry.id == id && entry.type < type);
+        });
+
+    if (i == entries_.end() || i->id != id || i->type != type) {
+        return nullptr;
+    }
+
+    return &*i;
+}
+
+//------------------------------------------------------------------------------
+BinaFile DrsFile::binaFile(const Entry &entry) const
+{
+    BinaFile bina(entry.size);
+    bina.setInitialReadPosition(entry.offset);
+
+    return bina;
+}
+
 std::vector<uint32_t> DrsFile::binaryFileIds() const
 {
     std::vector<uint32_t> ret;
 
-    for (const std::pair<const uint32_t, BinaFilePtr> &entry : bina_map_) {
-        ret.push_back(entry.first);
+    for (const Entry &entry : entries_) {
+        if (entry.type == ENTRY_BINA) {
+            ret.push_back(entry.id);
+        }
     }
 
     return ret;
@@ -231,8 +384,10 @@ std::vector<uint32_t> DrsFile::slpFileIds() const
 {
     std::vector<uint32_t> ret;
 
-    for (const std::pair<const uint32_t, SlpFilePtr> &entry : slp_map_) {
-        ret.push_back(entry.first);
+    for (const Entry &entry : entries_) {
+        if (entry.type == ENTRY_SLP) {
+            ret.push_back(entry.id);
+        }
     }
 
     return ret;
@@ -241,6 +396,8 @@ std::vector<uint32_t> DrsFile::slpFileIds() const
 //------------------------------------------------------------------------------
 void DrsFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_DRS);
+
     loadHeader();
 }
 
@@ -280,37 +437,49 @@ void DrsFile::loadHeader()
             table_num_of_files_.push_back(read<uint32_t>());
         }
 
+        bool tablesKnown = true;
+
         // Load file headers
-        for (uint32_t i = 0; i < num_of_tables_; ++i) {
+        for (uint32_t i = 0; i < num_of_tables_ && tablesKnown; ++i) {
             if (tellg() != table_offsets[i]) {
                 log.error("Tables aren't layed out linearly, is at position %d, but should be at %d", tellg(), table_offsets[i]);
             }
 
+            EntryType type;
+
+            if (table_types_[i].compare(slpTableHeader) == 0) {
+                type = ENTRY_SLP;
+            } else if (table_types_[i].compare(binaryTableHeader) == 0) {
+                type = ENTRY_BINA;
+            } else if (table_types_[i].compare(soundTableHeader) == 0) {
+                type = ENTRY_WAV;
+            } else {
+                std::cerr << "unknown header " << std::hex << table_types_[i] << std::dec << std::endl;
+                tablesKnown = false;
+                break;
+//                log.error("unknown file header: %s", table_types_[i]);
+            }
+
             for (uint32_t j = 0; j < table_num_of_files_[i]; ++j) {
                 uint32_t id = read<uint32_t>();
                 uint32_t pos = read<uint32_t>();
                 uint32_t len = read<uint32_t>();
 
-                if (table_types_[i].compare(slpTableHeader) == 0) {
-                    SlpFilePtr slp(new SlpFile(len));
-                    slp->setInitialReadPosition(pos);
-
-                    slp_map_[id] = slp;
-                } else if (table_types_[i].compare(binaryTableHeader) == 0) {
-                    BinaFilePtr bina(new BinaFile(len));
-                    bina->setInitialReadPosition(pos);
-
-                    bina_map_[id] = bina;
-                } else if (table_types_[i].compare(soundTableHeader) == 0) {
-                    wav_offsets_[id] = pos;
-                } else {
-                    std::cerr << "unknown header " << std::hex << table_types_[i] << std::dec << std::endl;
-                    return;
-//                    log.error("unknown file header: %s", table_types_[i]);
-                }
+                entries_.push_back({ id, pos, len, type });
             }
         }
 
+        // Each table is sorted by id already, but the ids of the tables mix.
+        std::sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b) {
+            return a.id < b.id || (a.id == b.id && a.type < b.type);
+        });
+
+        slp_files_.resize(entries_.size());
+
+        if (!tablesKnown) {
+            return;
+        }
+
         header_loaded_ = true;
     }
 }
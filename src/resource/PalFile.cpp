@@ -49,6 +49,8 @@ size_t PalFile::size() const
 //------------------------------------------------------------------------------
 void PalFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_PALETTE);
+
     if (isOperation(OP_READ)) {
         std::istream *istr = getIStream();
 
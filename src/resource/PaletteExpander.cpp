@@ -0,0 +1,310 @@
+/*
+    Expands palette indexes to RGBA colors
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/resource/PaletteExpander.h"
+
+#include "genie/resource/Color.h"
+#include "genie/resource/SmpFrame.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GENIE_PALETTE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only allow the intrinsics in functions built for the
+// instruction set, MSVC allows them anywhere.
+#if defined(GENIE_PALETTE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GENIE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GENIE_TARGET(isa)
+#endif
+
+namespace genie {
+
+static_assert(sizeof(SmpPixel) == 4, "SMP pixels are read as 32 bit integers");
+
+namespace {
+
+/// Index and section bits of an SMP pixel read as a little endian integer
+const uint32_t SMP_INDEX_MASK = 0x3FF;
+
+typedef void (*ExpandBytes)(const uint8_t *, size_t, const uint32_t *, uint32_t *, uint8_t);
+typedef void (*ExpandSmp)(const uint8_t *, size_t, const uint32_t *, uint32_t *);
+
+//------------------------------------------------------------------------------
+inline uint32_t readPixel(const uint8_t *pixel)
+{
+    return uint32_t(pixel[0]) | uint32_t(pixel[1]) << 8;
+}
+
+//------------------------------------------------------------------------------
+void expandBytesScalar(const uint8_t *indexes, size_t count, const uint32_t *colors,
+                       uint32_t *rgba, uint8_t offset)
+{
+    for (size_t i = 0; i < count; ++i) {
+        rgba[i] = colors[uint8_t(indexes[i] + offset)];
+    }
+}
+
+//------------------------------------------------------------------------------
+void expandSmpScalar(const uint8_t *pixels, size_t count, const uint32_t *colors, uint32_t *rgba)
+{
+    for (size_t i = 0; i < count; ++i) {
+        rgba[i] = colors[readPixel(pixels + 4 * i) & SMP_INDEX_MASK];
+    }
+}
+
+#ifdef GENIE_PALETTE_X86
+//------------------------------------------------------------------------------
+/// Looks up the colors of bytes First to First + 3 of indexes.
+//
+template <int First>
+GENIE_TARGET("sse4.1")
+inline __m128i lookupBytes(__m128i indexes, const uint32_t *colors)
+{
+    __m128i result = _mm_cvtsi32_si128(int(colors[_mm_extract_epi8(indexes, First)]));
+    result = _mm_insert_epi32(result, int(colors[_mm_extract_epi8(indexes, First + 1)]), 1);
+    result = _mm_insert_epi32(result, int(colors[_mm_extract_epi8(indexes, First + 2)]), 2);
+    return _mm_insert_epi32(result, int(colors[_mm_extract_epi8(indexes, First + 3)]), 3);
+}
+
+//------------------------------------------------------------------------------
+GENIE_TARGET("sse4.1")
+void expandBytesSse41(const uint8_t *indexes, size_t count, const uint32_t *colors,
+                      uint32_t *rgba, uint8_t offset)
+{
+    const __m128i add = _mm_set1_epi8(char(offset));
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(indexes + i)), add);
+        __m128i *out = reinterpret_cast<__m128i *>(rgba + i);
+
+        _mm_storeu_si128(out, lookupBytes<0>(bytes, colors));
+        _mm_storeu_si128(out + 1, lookupBytes<4>(bytes, colors));
+        _mm_storeu_si128(out + 2, lookupBytes<8>(bytes, colors));
+        _mm_storeu_si128(out + 3, lookupBytes<12>(bytes, colors));
+    }
+
+    expandBytesScalar(indexes + i, count - i, colors, rgba + i, offset);
+}
+
+//------------------------------------------------------------------------------
+GENIE_TARGET("avx2")
+void expandBytesAvx2(const uint8_t *indexes, size_t count, const uint32_t *colors,
+                     uint32_t *rgba, uint8_t offset)
+{
+    const __m128i add = _mm_set1_epi8(char(offset));
+    const int *table = reinterpret_cast<const int *>(colors);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(indexes + i)), add);
+        const __m256i low = _mm256_cvtepu8_epi32(bytes);
+        const __m256i high = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+        __m256i *out = reinterpret_cast<__m256i *>(rgba + i);
+
+        _mm256_storeu_si256(out, _mm256_i32gather_epi32(table, low, 4));
+        _mm256_storeu_si256(out + 1, _mm256_i32gather_epi32(table, high, 4));
+    }
+
+    expandBytesScalar(indexes + i, count - i, colors, rgba + i, offset);
+}
+
+//------------------------------------------------------------------------------
+GENIE_TARGET("avx2")
+void expandSmpAvx2(const uint8_t *pixels, size_t count, const uint32_t *colors, uint32_t *rgba)
+{
+    const __m256i mask = _mm256_set1_epi32(int(SMP_INDEX_MASK));
+    const int *table = reinterpret_cast<const int *>(colors);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const __m256i indexes = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + 4 * i)), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgba + i), _mm256_i32gather_epi32(table, indexes, 4));
+    }
+
+    expandSmpScalar(pixels + 4 * i, count - i, colors, rgba + i);
+}
+
+//------------------------------------------------------------------------------
+bool cpuHas(PaletteExpander::Kernel kernel)
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse41 = info[2] & (1 << 19);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+
+    bool avx2 = false;
+
+    // AVX2 also needs the OS to save the YMM registers.
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = info[1] & (1 << 5);
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    switch (kernel) {
+    case PaletteExpander::KERNEL_SCALAR:
+        return true;
+
+    case PaletteExpander::KERNEL_SSE41:
+        return sse41;
+
+    case PaletteExpander::KERNEL_AVX2:
+        return avx2;
+
+    default:
+        return false;
+    }
+}
+#else
+//------------------------------------------------------------------------------
+bool cpuHas(PaletteExpander::Kernel kernel)
+{
+    return kernel == PaletteExpander::KERNEL_SCALAR;
+}
+#endif
+
+struct Functions {
+    ExpandBytes bytes;
+    ExpandSmp smp;
+};
+
+const Functions functions[PaletteExpander::KERNEL_COUNT] = {
+    { expandBytesScalar, expandSmpScalar },
+#ifdef GENIE_PALETTE_X86
+    // Inserting the colors of SMP pixels one by one into vectors is slower
+    // than the scalar loop, they don't need widening like bytes.
+    { expandBytesSse41, expandSmpScalar },
+    { expandBytesAvx2, expandSmpAvx2 },
+#else
+    { expandBytesScalar, expandSmpScalar },
+    { expandBytesScalar, expandSmpScalar },
+#endif
+};
+
+//------------------------------------------------------------------------------
+/// The kernel in use, the best one is picked on first use.
+//
+std::atomic<int> &currentKernel()
+{
+    static std::atomic<int> kernel{ []() {
+        for (int kernel = PaletteExpander::KERNEL_COUNT - 1; kernel > 0; --kernel) {
+            if (cpuHas(PaletteExpander::Kernel(kernel))) {
+                return kernel;
+            }
+        }
+
+        return int(PaletteExpander::KERNEL_SCALAR);
+    }() };
+
+    return kernel;
+}
+
+//------------------------------------------------------------------------------
+inline const Functions &current()
+{
+    return functions[currentKernel().load(std::memory_order_relaxed)];
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+void PaletteExpander::expand(const uint8_t *indexes, size_t count, const uint32_t *colors,
+                             uint32_t *rgba, uint8_t offset)
+{
+    current().bytes(indexes, count, colors, rgba, offset);
+}
+
+//------------------------------------------------------------------------------
+void PaletteExpander::expand(const SmpPixel *pixels, size_t count, const uint32_t *colors,
+                             uint32_t *rgba)
+{
+    current().smp(reinterpret_cast<const uint8_t *>(pixels), count, colors, rgba);
+}
+
+//------------------------------------------------------------------------------
+void PaletteExpander::fillTable(const std::vector<Color> &colors, uint32_t *table, size_t size)
+{
+    const size_t count = std::min(colors.size(), size);
+
+    for (size_t i = 0; i < count; ++i) {
+        table[i] = colors[i].toUint32();
+    }
+
+    std::fill(table + count, table + size, 0);
+}
+
+//------------------------------------------------------------------------------
+PaletteExpander::Kernel PaletteExpander::getKernel(void)
+{
+    return Kernel(currentKernel().load(std::memory_order_relaxed));
+}
+
+//------------------------------------------------------------------------------
+bool PaletteExpander::setKernel(Kernel kernel)
+{
+    if (!isSupported(kernel)) {
+        return false;
+    }
+
+    currentKernel().store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool PaletteExpander::isSupported(Kernel kernel)
+{
+    return kernel >= KERNEL_SCALAR && kernel < KERNEL_COUNT && cpuHas(kernel);
+}
+
+//------------------------------------------------------------------------------
+const char *PaletteExpander::getKernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case KERNEL_SCALAR:
+        return "scalar";
+
+    case KERNEL_SSE41:
+        return "sse4.1";
+
+    case KERNEL_AVX2:
+        return "avx2";
+
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace genie
@@ -19,11 +19,15 @@
 
 #include "genie/resource/SlpFile.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <chrono>
+#include <exception>
+#include <future>
 
 #include "genie/resource/SlpFrame.h"
 #include "genie/resource/PalFile.h"
+#include "genie/util/ThreadPool.h"
 
 namespace genie {
 
@@ -39,6 +43,8 @@ SlpFile::SlpFile(const size_t size) :
 //------------------------------------------------------------------------------
 void SlpFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_SLP);
+
     if (isOperation(OP_READ) && !loaded_) {
         loadFile();
     } else if (isOperation(OP_WRITE)) { // && loaded_)
@@ -49,40 +55,73 @@ void SlpFile::serializeObject()
 //------------------------------------------------------------------------------
 void SlpFile::loadFile()
 {
-    serializeHeader();
-
-    frames_.resize(num_frames_);
-
-    if (m_graphicsFileData.empty()) {
+    const MemoryStreamBuf *memory = dynamic_cast<const MemoryStreamBuf *>(getIStream()->rdbuf());
+    const size_t start = getInitialReadPosition();
+
+    if (getLoadMode() == LOAD_MAPPED && memory && start <= memory->size()) {
+        // The frames are decoded from where the file is, without a copy.
+        data_ = ByteSpan(memory->begin() + start, std::min(size_, memory->size() - start));
+    } else if (m_graphicsFileData.empty()) {
+        // Copied with one read, the headers are read from the copy.
         m_graphicsFileData.resize(size_, 0);
-        std::streampos orig = getIStream()->tellg();
-        getIStream()->seekg(getInitialReadPosition());
         char *data = reinterpret_cast<char *>(m_graphicsFileData.data());
         getIStream()->read(data, size_);
-        getIStream()->seekg(orig);
-    } else {
-        std::cerr << "already loaded data" << std::endl;
+        data_ = ByteSpan(m_graphicsFileData.data(), m_graphicsFileData.size());
     }
 
-    // Load frame headers
-    for (uint32_t i = 0; i < num_frames_; ++i) {
-        frames_[i] = SlpFramePtr(new SlpFrame());
-        frames_[i]->setSlpFilePos(std::streampos(0));
-        frames_[i]->setLoadParams(*getIStream());
-        frames_[i]->serializeHeader();
+    loadFromData();
+}
+
+//------------------------------------------------------------------------------
+void SlpFile::loadFromData()
+{
+    // The stream the file was loaded from isn't needed again, it may be
+    // shared with other files or gone. The headers are read with a stream
+    // over the data, which ends with this function.
+    MemoryStreamBuf buffer(data_.data(), data_.size());
+    std::istream istr(&buffer);
+    setIStream(istr);
+
+    try {
+        serializeHeader();
+
+        frames_.resize(num_frames_);
+
+        // Load frame headers
+        for (uint32_t i = 0; i < num_frames_; ++i) {
+            frames_[i] = SlpFramePtr(new SlpFrame());
+            frames_[i]->setSlpFilePos(std::streampos(0));
+            frames_[i]->setLoadParams(*getIStream());
+            frames_[i]->serializeHeader();
+            frames_[i]->clearLoadParams();
+        }
+    } catch (...) {
+        clearIStream();
+        frames_.clear();
+        throw;
     }
 
-    const char *data = reinterpret_cast<const char *>(m_graphicsFileData.data());
-    std::istringstream istr(std::string(data, m_graphicsFileData.size()));
+    clearIStream();
 
     // Load frame header
     for (uint32_t i = 0; i < num_frames_; ++i) {
-        frames_[i]->load(istr);
+        frames_[i]->load(data_);
     }
 
     loaded_ = true;
 }
 
+//------------------------------------------------------------------------------
+void SlpFile::reload()
+{
+    if (data_.empty()) {
+        throw std::logic_error("SLP file was never loaded");
+    }
+
+    setOperation(OP_READ);
+    loadFromData();
+}
+
 //------------------------------------------------------------------------------
 void SlpFile::saveFile()
 {
@@ -149,7 +188,7 @@ const SlpFramePtr &SlpFile::getFrame(uint32_t frame)
 #ifndef NDEBUG
             log.debug("Reloading SLP, seeking frame [%u]", frame);
 #endif
-            readObject(*getIStream());
+            reload();
             return getFrame(frame);
         }
 
@@ -157,17 +196,12 @@ const SlpFramePtr &SlpFile::getFrame(uint32_t frame)
         throw std::out_of_range("getFrame()");
     }
 
-    if (frames_[frame]->img_data.pixel_indexes.empty()) {
-        const char *data = reinterpret_cast<const char *>(m_graphicsFileData.data());
-        std::istringstream istr(std::string(data, m_graphicsFileData.size()));
-        frames_[frame]->setLoadParams(istr);
-        frames_[frame]->readImage();
+    if (!isDecoded(*frames_[frame])) {
+        frames_[frame]->readImage(data_);
 
         if (frames_[frame]->getWidth() == 0) {
             log.debug("Got null frame");
         }
-
-        frames_[frame]->setLoadParams(*getIStream());
     }
 
     return frames_[frame];
@@ -181,10 +215,83 @@ void SlpFile::setFrame(uint32_t frame, SlpFramePtr data)
     }
 }
 
+//------------------------------------------------------------------------------
+void SlpFile::decodeAllFrames(ThreadPool &pool)
+{
+    if (!loaded_) {
+        reload();
+    }
+
+    std::vector<SlpFrame *> pending;
+
+    for (const SlpFramePtr &frame : frames_) {
+        if (!isDecoded(*frame)) {
+            pending.push_back(frame.get());
+        }
+    }
+
+    // A few batches per thread balance frames of different sizes without
+    // queueing a task for each small frame.
+    const size_t batchCount = std::min(pending.size(), 4 * (pool.threadCount() + 1));
+    std::vector<std::future<void>> decodes;
+    decodes.reserve(batchCount);
+
+    for (size_t batch = 0; batch < batchCount; batch++) {
+        decodes.push_back(pool.submit([this, &pending, batch, batchCount]() {
+            for (size_t i = batch; i < pending.size(); i += batchCount) {
+                pending[i]->readImage(data_);
+            }
+        }));
+    }
+
+    std::exception_ptr error;
+
+    for (std::future<void> &decode : decodes) {
+        // Help out instead of just waiting.
+        while (decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+               pool.runPendingTask()) {
+        }
+
+        try {
+            decode.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool SlpFile::isDecoded(const SlpFrame &frame)
+{
+    return frame.is32bit() ? !frame.img_data.bgra_channels.empty() : !frame.img_data.pixel_indexes.empty();
+}
+
+//------------------------------------------------------------------------------
+bool SlpFile::decodeFrameRgba(uint32_t frame, const PalFile &palette, uint8_t player,
+                              uint32_t *pixels, size_t stride, const SlpRgbaColors &colors)
+{
+    if (!loaded_) {
+        reload();
+    }
+
+    if (frame >= frames_.size()) {
+        log.error("Trying to get frame [%u] from index out of range!", frame);
+        throw std::out_of_range("decodeFrameRgba()");
+    }
+
+    return frames_[frame]->decodeRgba(data_, palette, player, pixels, stride, colors);
+}
+
 int SlpFile::frameCommandsOffset(const size_t frame, const int row)
 {
     if (!loaded_) {
-        readObject(*getIStream());
+        reload();
     }
 
     if (frame >= frames_.size()) {
@@ -198,7 +305,7 @@ int SlpFile::frameCommandsOffset(const size_t frame, const int row)
 int SlpFile::frameHeight(const size_t frame)
 {
     if (!loaded_) {
-        readObject(*getIStream());
+        reload();
     }
 
     if (frame >= frames_.size()) {
@@ -212,7 +319,7 @@ int SlpFile::frameHeight(const size_t frame)
 int SlpFile::frameWidth(const size_t frame)
 {
     if (!loaded_) {
-        readObject(*getIStream());
+        reload();
     }
 
     if (frame >= frames_.size()) {
@@ -20,6 +20,9 @@
 #include "genie/resource/SlpFrame.h"
 #include "genie/resource/SlpTemplate.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream>
 //Debug
 #include <cassert>
@@ -27,11 +30,27 @@
 #include <chrono>
 
 #include "genie/resource/Color.h"
+#include "genie/resource/PaletteExpander.h"
 
 namespace genie {
 
 Logger &SlpFrame::log = Logger::getLogger("genie.SlpFrame");
 
+namespace {
+
+//------------------------------------------------------------------------------
+/// Reads a value in the byte order of the host, like ISerializable does.
+//
+template <typename T>
+inline T readValue(const uint8_t *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
 //------------------------------------------------------------------------------
 void SlpFrame::setSlpFilePos(std::streampos pos)
 {
@@ -91,25 +110,10 @@ void SlpFrame::enlarge(const size_t width, const size_t height, const int32_t of
     }
 
     // You better not crop the frame.
-    for (XY &xy : img_data.shadow_mask) {
-        xy.x += offset_x;
-        xy.y += offset_y;
-    }
-
-    for (XY &xy : img_data.shield_mask) {
-        xy.x += offset_x;
-        xy.y += offset_y;
-    }
-
-    for (XY &xy : img_data.outline_pc_mask) {
-        xy.x += offset_x;
-        xy.y += offset_y;
-    }
-
-    for (PlayerColorXY &xy : img_data.player_color_mask) {
-        xy.x += offset_x;
-        xy.y += offset_y;
-    }
+    img_data.shadow_mask.offset(offset_x, offset_y);
+    img_data.shield_mask.offset(offset_x, offset_y);
+    img_data.outline_pc_mask.offset(offset_x, offset_y);
+    img_data.player_color_mask.offset(offset_x, offset_y);
 
     hotspot_x += offset_x;
     hotspot_y += offset_y;
@@ -177,6 +181,11 @@ void SlpFrame::setLoadParams(std::istream &istr)
     setOperation(OP_READ);
 }
 
+void SlpFrame::clearLoadParams(void)
+{
+    clearIStream();
+}
+
 void SlpFrame::setSaveParams(std::ostream &ostr, uint32_t &slp_offset_)
 {
     setOStream(ostr);
@@ -195,30 +204,24 @@ void SlpFrame::setSaveParams(std::ostream &ostr, uint32_t &slp_offset_)
     right_edges_.resize(height_);
     cmd_offsets_.resize(height_);
     commands_.resize(height_);
-    uint32_t player_color_slot = 0;
-    uint32_t shadow_slot = 0;
-    uint32_t shield_slot = 0;
-    uint32_t outline_pc_slot = 0;
-    uint32_t transparent_slot = 0;
 
     // Ensure that all 8-bit masks get saved.
-    for (const XY &pixel : img_data.outline_pc_mask) {
-        img_data.alpha_channel[pixel.y * width_ + pixel.x] = 255;
+    for (const SlpPixelMask<XY>::Span &span : img_data.outline_pc_mask.spans()) {
+        std::fill_n(&img_data.alpha_channel[span.y * width_ + span.x], span.count, 255);
     }
 
-    for (const XY &pixel : img_data.shield_mask) {
-        img_data.alpha_channel[pixel.y * width_ + pixel.x] = 255;
+    for (const SlpPixelMask<XY>::Span &span : img_data.shield_mask.spans()) {
+        std::fill_n(&img_data.alpha_channel[span.y * width_ + span.x], span.count, 255);
     }
 
     {
-        std::vector<XY> new_shadow_mask;
-        new_shadow_mask.reserve(img_data.shadow_mask.size());
+        SlpPixelMask<XY> new_shadow_mask;
 
         for (const XY &pixel : img_data.shadow_mask) {
             uint32_t loc = pixel.y * width_ + pixel.x;
 
             if (img_data.alpha_channel[loc] == 0) {
-                new_shadow_mask.emplace_back(pixel);
+                new_shadow_mask.push_back(pixel);
                 img_data.alpha_channel[loc] = 255;
             }
         }
@@ -226,6 +229,14 @@ void SlpFrame::setSaveParams(std::ostream &ostr, uint32_t &slp_offset_)
         img_data.shadow_mask = std::move(new_shadow_mask);
     }
 
+    // The masks are in the order of the pixels, each is checked at the next
+    // pixel until it matches.
+    SlpPixelMask<PlayerColorXY>::const_iterator player_color_slot = img_data.player_color_mask.begin();
+    SlpPixelMask<XY>::const_iterator shadow_slot = img_data.shadow_mask.begin();
+    SlpPixelMask<XY>::const_iterator shield_slot = img_data.shield_mask.begin();
+    SlpPixelMask<XY>::const_iterator outline_pc_slot = img_data.outline_pc_mask.begin();
+    SlpPixelMask<XY>::const_iterator transparent_slot = img_data.transparency_mask.begin();
+
     for (uint32_t row = 0; row < height_; ++row) {
         cmd_offsets_[row] = slp_offset_;
         // Count left edge
@@ -267,36 +278,32 @@ void SlpFrame::setSaveParams(std::ostream &ostr, uint32_t &slp_offset_)
             uint32_t last_bgra = bgra;
             cnt_type old_count = count_type;
 
-            if (player_color_slot < img_data.player_color_mask.size()) {
-                if (img_data.player_color_mask[player_color_slot].x == col
-                        && img_data.player_color_mask[player_color_slot].y == row) {
+            if (player_color_slot != img_data.player_color_mask.end()) {
+                if (player_color_slot->x == col && player_color_slot->y == row) {
                     count_type = CNT_PLAYER;
                     ++player_color_slot;
                     goto COUNT_SWITCH;
                 }
             }
 
-            if (outline_pc_slot < img_data.outline_pc_mask.size()) {
-                if (img_data.outline_pc_mask[outline_pc_slot].x == col
-                        && img_data.outline_pc_mask[outline_pc_slot].y == row) {
+            if (outline_pc_slot != img_data.outline_pc_mask.end()) {
+                if (outline_pc_slot->x == col && outline_pc_slot->y == row) {
                     count_type = CNT_PC_OUTLINE;
                     ++outline_pc_slot;
                     goto COUNT_SWITCH;
                 }
             }
 
-            if (shield_slot < img_data.shield_mask.size()) {
-                if (img_data.shield_mask[shield_slot].x == col
-                        && img_data.shield_mask[shield_slot].y == row) {
+            if (shield_slot != img_data.shield_mask.end()) {
+                if (shield_slot->x == col && shield_slot->y == row) {
                     count_type = CNT_SHIELD;
                     ++shield_slot;
                     goto COUNT_SWITCH;
                 }
             }
 
-            if (shadow_slot < img_data.shadow_mask.size()) {
-                if (img_data.shadow_mask[shadow_slot].x == col
-                        && img_data.shadow_mask[shadow_slot].y == row) {
+            if (shadow_slot != img_data.shadow_mask.end()) {
+                if (shadow_slot->x == col && shadow_slot->y == row) {
                     count_type = CNT_SHADOW;
                     ++shadow_slot;
                     goto COUNT_SWITCH;
@@ -306,9 +313,8 @@ void SlpFrame::setSaveParams(std::ostream &ostr, uint32_t &slp_offset_)
             if (is32bit()) {
                 bgra = img_data.bgra_channels[row * width_ + col];
 
-                if (transparent_slot < img_data.transparency_mask.size()) {
-                    if (img_data.transparency_mask[transparent_slot].x == col
-                            && img_data.transparency_mask[transparent_slot].y == row) {
+                if (transparent_slot != img_data.transparency_mask.end()) {
+                    if (transparent_slot->x == col && transparent_slot->y == row) {
                         count_type = CNT_FEATHERING;
                         ++transparent_slot;
                         goto COUNT_SWITCH;
@@ -402,45 +408,197 @@ void SlpFrame::serializeHeader(void)
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::load(std::istream &istr)
+void SlpFrame::load(ByteSpan data)
 {
-    setIStream(istr);
+    const size_t base = size_t(std::streamoff(slp_file_pos_));
 
     //----------------------------------------------------------------------------
     /// Reads the edges of the frame. An edge int is the number of pixels in
     /// a row which are transparent. There are two 16 bit unsigned integers for
     /// each side of a row. One starting from left and the other starting from the
     /// right side.
-    istr.seekg(slp_file_pos_ + std::streampos(outline_table_offset_));
+    const ByteSpan edges = data.subspan(base + outline_table_offset_, 4 * size_t(height_));
 
     left_edges_.resize(height_, 0);
     right_edges_.resize(height_, 0);
 
-    for (uint32_t row = 0; row < height_; ++row) {
-        serialize<uint16_t>(left_edges_[row]);
-        serialize<uint16_t>(right_edges_[row]);
+    for (uint32_t row = 0; row < edges.size() / 4; ++row) {
+        left_edges_[row] = readValue<uint16_t>(edges.data() + 4 * row);
+        right_edges_[row] = readValue<uint16_t>(edges.data() + 4 * row + 2);
     }
 
-    istr.seekg(slp_file_pos_ + std::streampos(cmd_table_offset_));
-    serialize<uint32_t>(cmd_offsets_, height_);
+    // Rows cut off by the end of the file start at offset 0, like reading
+    // past the end of a stream gives.
+    const ByteSpan offsets = data.subspan(base + cmd_table_offset_, 4 * size_t(height_));
+
+    cmd_offsets_.assign(height_, 0);
+
+    for (uint32_t row = 0; row < offsets.size() / 4; ++row) {
+        cmd_offsets_[row] = readValue<uint32_t>(offsets.data() + 4 * row);
+    }
 
     // Read embedded palette
     if (properties_ == 0x78) {
-        istr.seekg(slp_file_pos_ + std::streampos(palette_offset_));
-        img_data.palette.resize(read<uint32_t>(), genie::Color::Transparent);
+        const ByteSpan palette = data.subspan(base + palette_offset_, data.size());
+        size_t count = 0;
+
+        if (palette.size() >= 4) {
+            count = std::min<size_t>(readValue<uint32_t>(palette.data()), (palette.size() - 4) / 3);
+        }
+
+        img_data.palette.resize(count, genie::Color::Transparent);
 
-        for (genie::Color &rgba : img_data.palette) {
-            rgba.r = read<uint8_t>();
-            rgba.g = read<uint8_t>();
-            rgba.b = read<uint8_t>();
+        for (size_t i = 0; i < count; ++i) {
+            genie::Color &rgba = img_data.palette[i];
+            rgba.r = palette[4 + 3 * i];
+            rgba.g = palette[4 + 3 * i + 1];
+            rgba.b = palette[4 + 3 * i + 2];
         }
     }
 }
 
-void SlpFrame::readImage()
-{
-    std::istream &istr = *getIStream();
+//------------------------------------------------------------------------------
+/// Writes the pixels decodeCommands() parses into the image data of a frame.
+//
+struct SlpFrame::ImageTarget {
+    SlpFrame &frame;
+
+    inline void beginRow(uint32_t /*row*/)
+    {
+    }
+
+    inline void copyPixels(uint32_t row, uint32_t col, uint32_t count, const uint8_t *pixels, uint8_t special)
+    {
+        if (frame.is32bit()) {
+            frame.readPixelsToImage32(row, col, count, pixels, special);
+        } else if (special != 2) {
+            frame.readPixelsToImage(row, col, count, pixels, special == 1);
+        }
+    }
+
+    inline void fillPixels(uint32_t row, uint32_t col, uint32_t count, const uint8_t *color, bool player_col)
+    {
+        if (frame.is32bit()) {
+            frame.setPixelsToColor32(row, col, count, readValue<uint32_t>(color), player_col);
+        } else {
+            frame.setPixelsToColor(row, col, count, *color, player_col);
+        }
+    }
 
+    inline void shadowPixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        frame.setPixelsToShadow(row, col, count);
+    }
+
+    inline void shieldPixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        frame.setPixelsToShield(row, col, count);
+    }
+
+    inline void pcOutlinePixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        frame.setPixelsToPcOutline(row, col, count);
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Writes the pixels decodeCommands() parses as RGBA, with the colors looked
+/// up in a palette. Rows are cleared when they begin.
+//
+struct SlpFrame::RgbaTarget {
+    uint32_t *pixels;
+    size_t stride;
+    uint32_t width;
+    bool is32bit;
+
+    /// The palette as RGBA
+    std::array<uint32_t, 256> colors;
+
+    /// Added to the index of player color pixels
+    uint8_t player_base;
+
+    SlpRgbaColors special;
+
+    /// Rows begun so far
+    uint32_t rows = 0;
+
+    inline uint32_t *at(uint32_t row, uint32_t col)
+    {
+        return pixels + row * stride + col;
+    }
+
+    //----------------------------------------------------------------------------
+    /// Pixels of a run that are inside of the row. Broken frames can have runs
+    /// going past the end of a row, which must not reach the rest of the
+    /// stride.
+    //
+    inline uint32_t clip(uint32_t col, uint32_t count) const
+    {
+        return col < width ? std::min(count, width - col) : 0;
+    }
+
+    //----------------------------------------------------------------------------
+    /// BGRA as read from the file to RGBA.
+    //
+    static inline uint32_t fromBgra(uint32_t bgra)
+    {
+        return (bgra & 0xFF00FF00) | ((bgra >> 16) & 0xFF) | ((bgra & 0xFF) << 16);
+    }
+
+    inline void beginRow(uint32_t row)
+    {
+        std::fill_n(at(row, 0), width, 0);
+        rows = row + 1;
+    }
+
+    inline void copyPixels(uint32_t row, uint32_t col, uint32_t count, const uint8_t *source, uint8_t special)
+    {
+        uint32_t *target = at(row, col);
+        count = clip(col, count);
+
+        if (is32bit) {
+            for (uint32_t i = 0; i < count; ++i) {
+                target[i] = fromBgra(readValue<uint32_t>(source + 4 * i));
+            }
+        } else if (special == 1) {
+            PaletteExpander::expand(source, count, colors.data(), target, player_base);
+        } else if (special == 0) {
+            PaletteExpander::expand(source, count, colors.data(), target);
+        }
+    }
+
+    inline void fillPixels(uint32_t row, uint32_t col, uint32_t count, const uint8_t *color, bool player_col)
+    {
+        uint32_t rgba;
+
+        if (is32bit) {
+            rgba = fromBgra(readValue<uint32_t>(color));
+        } else {
+            rgba = colors[player_col ? uint8_t(*color + player_base) : *color];
+        }
+
+        std::fill_n(at(row, col), clip(col, count), rgba);
+    }
+
+    inline void shadowPixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        std::fill_n(at(row, col), clip(col, count), special.shadow);
+    }
+
+    inline void shieldPixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        std::fill_n(at(row, col), clip(col, count), special.shield);
+    }
+
+    inline void pcOutlinePixels(uint32_t row, uint32_t col, uint32_t count)
+    {
+        std::fill_n(at(row, col), clip(col, count), special.outline_pc);
+    }
+};
+
+//------------------------------------------------------------------------------
+void SlpFrame::readImage(ByteSpan file)
+{
     const size_t byteCount = width_ * height_;
 
     if (is32bit()) {
@@ -450,24 +608,84 @@ void SlpFrame::readImage()
         img_data.alpha_channel.resize(byteCount, 0);
     }
 
+    ImageTarget target{ *this };
     size_t pixelsRead = 0;
 
+    if (!decodeCommands(file, target, pixelsRead)) {
+        return;
+    }
+
+    if (pixelsRead == 0) {
+        width_ = 0;
+        height_ = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool SlpFrame::decodeRgba(ByteSpan file, const PalFile &palette, uint8_t player,
+                          uint32_t *pixels, size_t stride, const SlpRgbaColors &colors) const
+{
+    RgbaTarget target{ pixels, stride, width_, is32bit(), {}, uint8_t(16 * player), colors };
+
+    const std::vector<Color> &paletteColors = img_data.palette.empty() ? palette.colors_ : img_data.palette;
+    PaletteExpander::fillTable(paletteColors, target.colors.data(), target.colors.size());
+
+    size_t pixelsRead = 0;
+    const bool ok = decodeCommands(file, target, pixelsRead);
+
+    // Broken frames are transparent from where decoding stopped.
+    for (uint32_t row = target.rows; row < height_; ++row) {
+        target.beginRow(row);
+    }
+
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+template <typename Target>
+bool SlpFrame::decodeCommands(ByteSpan file, Target &target, size_t &pixelsRead) const
+{
+    const size_t byteCount = width_ * height_;
+    const size_t pixelSize = is32bit() ? 4 : 1;
+
+    const size_t base = size_t(std::streamoff(slp_file_pos_));
+    const uint8_t *const end = file.end();
+
     // Each row has it's commands, 0x0F signals the end of a rows commands.
     for (uint32_t row = 0; row < height_; ++row) {
-        istr.seekg(slp_file_pos_ + std::streampos(cmd_offsets_[row]));
-//        std::cout << "command offset: " << cmd_offsets_[row] << std::endl;
-//        std::cout << "file pos: " << slp_file_pos_ << std::endl;
-        assert(!istr.eof());
+        target.beginRow(row);
 
         // Transparent rows apparently read one byte anyway. NO THEY DO NOT! Ignore and use seekg()
         if (0x8000 == left_edges_[row] || 0x8000 == right_edges_[row]) { // Remember signedness!
             continue; // Pretend it does not exist.
         }
 
+        if (base + cmd_offsets_[row] >= file.size()) {
+            log.error("Commands of row [%u] are outside of the file", row);
+            return false;
+        }
+
+        const uint8_t *pos = file.data() + base + cmd_offsets_[row];
         uint32_t pix_pos = left_edges_[row]; //pos where to start putting pixels
 
+        // Running out of commands ends the row in the next iteration.
+        auto next = [&]() -> uint8_t {
+            return pos < end ? *pos++ : 0;
+        };
+
+        // Whether count pixels fit into the image at pix_pos, and bytes are
+        // left to read them from.
+        auto available = [&](uint32_t count, size_t bytes) {
+            return size_t(row) * width_ + pix_pos + count <= byteCount && size_t(end - pos) >= bytes;
+        };
+
         while (true) {
-            const uint8_t data = read<uint8_t>();
+            if (pos == end) {
+                log.error("Commands of row [%u] run past the end of the file", row);
+                return false;
+            }
+
+            const uint8_t data = *pos++;
 
             if (data == EndOfRow) {
                 break;
@@ -476,19 +694,11 @@ void SlpFrame::readImage()
             uint32_t pix_cnt = 0;
 
             const uint8_t low_bits = data & 0b11;
+            const uint8_t cmd = data & 0x0F;
+            const uint8_t sub = data & 0xF0;
 
             if (low_bits == 0) { // Lesser block copy
                 pix_cnt = (data & 0xFC) >> 2;
-
-                if (is32bit()) {
-                    readPixelsToImage32(row, pix_pos, pix_cnt);
-                } else {
-                    readPixelsToImage(row, pix_pos, pix_cnt);
-                }
-
-                pixelsRead += pix_cnt;
-
-                continue;
             } else if (low_bits == 1) { // Lesser skip (making pixels transparent)
                 pix_cnt = (data & 0xFC) >> 2;
                 pix_pos += pix_cnt;
@@ -496,64 +706,56 @@ void SlpFrame::readImage()
                 pixelsRead += pix_cnt;
 
                 continue;
+            } else if (cmd == GreaterBlockCopy || cmd == GreaterSkip) {
+                pix_cnt = (sub << 4) + next();
+            } else if (cmd == CopyAndTransform || cmd == FillColor || cmd == TransformBlock || cmd == Shadow) {
+                pix_cnt = getPixelCountFromData(data, pos, end);
             }
 
-            const uint8_t cmd = data & 0x0F;
-            const uint8_t sub = data & 0xF0;
+            if (low_bits == 0 || cmd == GreaterBlockCopy || cmd == CopyAndTransform) {
+                // Block copy, player color too for copy and transform.
+                const bool player_col = low_bits != 0 && cmd == CopyAndTransform;
 
-            switch (cmd) { //0x00
-            case GreaterBlockCopy: // Greater block copy
-                pix_cnt = (sub << 4) + read<uint8_t>();
-
-                if (is32bit()) {
-                    readPixelsToImage32(row, pix_pos, pix_cnt);
-                } else {
-                    readPixelsToImage(row, pix_pos, pix_cnt);
+                if (!available(pix_cnt, pix_cnt * pixelSize)) {
+                    log.error("Pixels of row [%u] don't fit into the frame", row);
+                    return false;
                 }
 
-                break;
+                target.copyPixels(row, pix_pos, pix_cnt, pos, player_col ? 1 : 0);
 
-            case GreaterSkip: // Greater skip
-                pix_cnt = (sub << 4) + read<uint8_t>();
+                pos += pix_cnt * pixelSize;
                 pix_pos += pix_cnt;
-                break;
-
-            case CopyAndTransform: // Copy and transform (player color)
-                pix_cnt = getPixelCountFromData(data);
+                pixelsRead += pix_cnt;
 
-                if (is32bit()) {
-                    readPixelsToImage32(row, pix_pos, pix_cnt, 1);
-                } else {
-                    readPixelsToImage(row, pix_pos, pix_cnt, true);
-                }
+                continue;
+            }
 
+            switch (cmd) { //0x00
+            case GreaterSkip: // Greater skip
+                pix_pos += pix_cnt;
                 break;
 
             case FillColor: // Run of plain color
-                pix_cnt = getPixelCountFromData(data);
-
-                if (is32bit()) {
-                    setPixelsToColor32(row, pix_pos, pix_cnt);
-                } else {
-                    setPixelsToColor(row, pix_pos, pix_cnt);
-                }
-
-                break;
-
             case TransformBlock: // Transform block (player color)
-                pix_cnt = getPixelCountFromData(data);
-
-                if (is32bit()) {
-                    setPixelsToColor32(row, pix_pos, pix_cnt, true);
-                } else {
-                    setPixelsToColor(row, pix_pos, pix_cnt, true);
+                if (!available(pix_cnt, pixelSize)) {
+                    log.error("Pixels of row [%u] don't fit into the frame", row);
+                    return false;
                 }
 
+                target.fillPixels(row, pix_pos, pix_cnt, pos, cmd == TransformBlock);
+
+                pos += pixelSize;
+                pix_pos += pix_cnt;
                 break;
 
             case Shadow: // Shadow pixels
-                pix_cnt = getPixelCountFromData(data);
-                setPixelsToShadow(row, pix_pos, pix_cnt);
+                if (!available(pix_cnt, 0)) {
+                    log.error("Pixels of row [%u] don't fit into the frame", row);
+                    return false;
+                }
+
+                target.shadowPixels(row, pix_pos, pix_cnt);
+                pix_pos += pix_cnt;
                 break;
 
             case ExtendedCommand: // Extended commands
@@ -561,203 +763,166 @@ void SlpFrame::readImage()
                 case ForwardDraw: // Forward draw
                 case ReverseDraw: // Reverse draw
                     log.error("Cmd [%] is obsolete", data);
-                    return;
+                    return false;
 
                 case NormalTransform: // Normal transform
                 case AlternativeTransform: // Alternative transform
                     log.error("Cmd [%] is obsolete", data);
-                    return;
+                    return false;
 
                 case OutlinePlayerColor:
-                    setPixelsToPcOutline(row, pix_pos, 1); //, 242);
-                    break;
-
+                case OutlinePlayerColorSpan:
                 case OutlineShieldColor:
-                    setPixelsToShield(row, pix_pos, 1); //, 0);
-                    break;
+                case OutlineShieldColorSpan:
+                    pix_cnt = (data == OutlinePlayerColor || data == OutlineShieldColor) ? 1 : next();
 
-                case OutlinePlayerColorSpan:
-                    pix_cnt = read<uint8_t>();
-                    setPixelsToPcOutline(row, pix_pos, pix_cnt); //, 242);
-                    break;
+                    if (!available(pix_cnt, 0)) {
+                        log.error("Pixels of row [%u] don't fit into the frame", row);
+                        return false;
+                    }
 
-                case OutlineShieldColorSpan:
-                    pix_cnt = read<uint8_t>();
-                    setPixelsToShield(row, pix_pos, pix_cnt); //, 0);
+                    if (data == OutlinePlayerColor || data == OutlinePlayerColorSpan) {
+                        target.pcOutlinePixels(row, pix_pos, pix_cnt); //, 242);
+                    } else {
+                        target.shieldPixels(row, pix_pos, pix_cnt); //, 0);
+                    }
+
+                    pix_pos += pix_cnt;
                     break;
 
                 case Dither: // Dither
                     log.error("Cmd [%X] not implemented", data);
-                    return;
+                    return false;
 
                 case PremultipliedAlpha: // Premultiplied alpha
                 case OriginalAlpha: // Original alpha
-                    pix_cnt = read<uint8_t>();
+                    pix_cnt = next();
 
                     if (is32bit()) {
-                        readPixelsToImage32(row, pix_pos, pix_cnt, 2);
+                        if (!available(pix_cnt, pix_cnt * pixelSize)) {
+                            log.error("Pixels of row [%u] don't fit into the frame", row);
+                            return false;
+                        }
+
+                        target.copyPixels(row, pix_pos, pix_cnt, pos, 2);
+                        pos += pix_cnt * pixelSize;
+                        pix_pos += pix_cnt;
                     }
 
                     break;
 
                 default:
                     log.error("Cmd [%] is unknown", int(data));
-                    return;
+                    return false;
                 }
 
                 break;
 
             default:
 //                log.error("Unknown cmd [%X]", data);
-                std::cerr << "SlpFrame: Unknown cmd at " << std::hex << tellg() << " " << std::hex << int(data) << std::endl;
-                return;
+                std::cerr << "SlpFrame: Unknown cmd at " << std::hex << (pos - 1 - file.data()) << " " << std::hex << int(data) << std::endl;
+                return false;
             }
 
             pixelsRead += pix_cnt;
         }
     }
 
-    if (pixelsRead == 0) {
-        width_ = 0;
-        height_ = 0;
-    }
-
+    return true;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::readPixelsToImage(uint32_t row, uint32_t &col,
-                                 uint32_t count, bool player_col)
+void SlpFrame::readPixelsToImage(uint32_t row, uint32_t &col, uint32_t count,
+                                 const uint8_t *pixels, bool player_col)
 {
-    uint32_t to_pos = col + count;
-
-    // optimizzzze
-    if (!player_col) {
-        getIStream()->read((char *)&img_data.pixel_indexes.data()[row * width_ + col], count);
-        memset(&img_data.alpha_channel[row * width_ + col], 255, count);
-        col += count;
-        return;
-    }
+    const size_t start = size_t(row) * width_ + col;
 
-    std::vector<char> bgras(count);
-    getIStream()->read(bgras.data(), count);
-    int i = 0;
+    memcpy(&img_data.pixel_indexes[start], pixels, count);
+    memset(&img_data.alpha_channel[start], 255, count);
 
-    while (col < to_pos) {
-        const uint8_t color_index = bgras[i++];
-
-        img_data.pixel_indexes[row * width_ + col] = color_index;
-        img_data.alpha_channel[row * width_ + col] = 255;
-
-        if (player_col) {
-            img_data.player_color_mask.push_back({ col, row, color_index });
-        }
-
-        ++col;
+    if (player_col) {
+        img_data.player_color_mask.append(col, row, count, pixels);
     }
+
+    col += count;
 }
 
 //------------------------------------------------------------------------------
-void SlpFrame::readPixelsToImage32(uint32_t row, uint32_t &col,
-                                   uint32_t count, uint8_t special)
+void SlpFrame::readPixelsToImage32(uint32_t row, uint32_t &col, uint32_t count,
+                                   const uint8_t *pixels, uint8_t special)
 {
-    uint32_t to_pos = col + count;
-
-    while (col < to_pos) {
-        uint32_t bgra = read<uint32_t>();
-        assert(row * width_ + col < img_data.bgra_channels.size());
-        img_data.bgra_channels[row * width_ + col] = bgra;
+    memcpy(&img_data.bgra_channels[size_t(row) * width_ + col], pixels, 4 * size_t(count));
 
-        if (special == 1) {
-            img_data.player_color_mask.push_back({ col, row, 0 });
-        } else if (special == 2) {
-            img_data.transparency_mask.push_back({ col, row });
-        }
-
-        ++col;
+    if (special == 1) {
+        img_data.player_color_mask.fill(col, row, count, 0);
+    } else if (special == 2) {
+        img_data.transparency_mask.append(col, row, count);
     }
+
+    col += count;
 }
 
 //------------------------------------------------------------------------------
 void SlpFrame::setPixelsToColor(uint32_t row, uint32_t &col, uint32_t count,
-                                bool player_col)
+                                uint8_t color_index, bool player_col)
 {
-    uint8_t color_index = read<uint8_t>();
-    uint32_t to_pos = col + count;
+    const size_t start = size_t(row) * width_ + col;
 
-    while (col < to_pos) {
-        assert(row * width_ + col < img_data.pixel_indexes.size());
-        img_data.pixel_indexes[row * width_ + col] = color_index;
-        img_data.alpha_channel[row * width_ + col] = 255;
+    memset(&img_data.pixel_indexes[start], color_index, count);
+    memset(&img_data.alpha_channel[start], 255, count);
 
-        if (player_col) {
-            img_data.player_color_mask.push_back({ col, row, color_index });
-        }
-
-        ++col;
+    if (player_col) {
+        img_data.player_color_mask.fill(col, row, count, color_index);
     }
+
+    col += count;
 }
 
 //------------------------------------------------------------------------------
 void SlpFrame::setPixelsToColor32(uint32_t row, uint32_t &col, uint32_t count,
-                                  bool player_col)
+                                  uint32_t bgra, bool player_col)
 {
-    uint32_t bgra = read<uint32_t>();
-    uint32_t to_pos = col + count;
+    const size_t start = size_t(row) * width_ + col;
 
-    while (col < to_pos) {
-        assert(row * width_ + col < img_data.bgra_channels.size());
-        img_data.bgra_channels[row * width_ + col] = bgra;
+    std::fill_n(img_data.bgra_channels.begin() + start, count, bgra);
 
-        if (player_col) {
-            img_data.player_color_mask.push_back({ col, row, 0 });
-        }
-
-        ++col;
+    if (player_col) {
+        img_data.player_color_mask.fill(col, row, count, 0);
     }
+
+    col += count;
 }
 
 //------------------------------------------------------------------------------
 void SlpFrame::setPixelsToShadow(const uint32_t row, uint32_t &col, const uint32_t count)
 {
-    uint32_t to_pos = col + count;
-
-    while (col < to_pos) {
-        img_data.shadow_mask.push_back({ col, row });
-        ++col;
-    }
+    img_data.shadow_mask.append(col, row, count);
+    col += count;
 }
 
 //------------------------------------------------------------------------------
 void SlpFrame::setPixelsToShield(const uint32_t row, uint32_t &col, const uint32_t count)
 {
-    uint32_t to_pos = col + count;
-
-    while (col < to_pos) {
-        img_data.shield_mask.push_back({ col, row });
-        ++col;
-    }
+    img_data.shield_mask.append(col, row, count);
+    col += count;
 }
 
 //------------------------------------------------------------------------------
 void SlpFrame::setPixelsToPcOutline(const uint32_t row, uint32_t &col, const uint32_t count)
 {
-    uint32_t to_pos = col + count;
-
-    while (col < to_pos) {
-        img_data.outline_pc_mask.push_back({ col, row });
-        ++col;
-    }
+    img_data.outline_pc_mask.append(col, row, count);
+    col += count;
 }
 
 //------------------------------------------------------------------------------
-uint8_t SlpFrame::getPixelCountFromData(uint8_t data)
+uint8_t SlpFrame::getPixelCountFromData(uint8_t data, const uint8_t *&pos, const uint8_t *end)
 {
     uint8_t pix_cnt;
 
     data = (data & 0xF0) >> 4;
 
     if (data == 0) {
-        pix_cnt = read<uint8_t>();
+        pix_cnt = pos < end ? *pos++ : 0;
     } else {
         pix_cnt = data;
     }
@@ -943,7 +1108,7 @@ SlpFramePtr SlpFrame::mirrorX(void)
         new_shadow_mask.emplace(pixel);
     }
 
-    new_data.shadow_mask = std::vector<XY>(new_shadow_mask.begin(), new_shadow_mask.end());
+    new_data.shadow_mask = SlpPixelMask<XY>(new_shadow_mask.begin(), new_shadow_mask.end());
 
     std::set<XY> new_shield_mask;
 
@@ -952,7 +1117,7 @@ SlpFramePtr SlpFrame::mirrorX(void)
         new_shield_mask.emplace(pixel);
     }
 
-    new_data.shield_mask = std::vector<XY>(new_shield_mask.begin(), new_shield_mask.end());
+    new_data.shield_mask = SlpPixelMask<XY>(new_shield_mask.begin(), new_shield_mask.end());
 
     std::set<XY> new_outline_pc_mask;
 
@@ -961,7 +1126,7 @@ SlpFramePtr SlpFrame::mirrorX(void)
         new_outline_pc_mask.emplace(pixel);
     }
 
-    new_data.outline_pc_mask = std::vector<XY>(new_outline_pc_mask.begin(), new_outline_pc_mask.end());
+    new_data.outline_pc_mask = SlpPixelMask<XY>(new_outline_pc_mask.begin(), new_outline_pc_mask.end());
 
     std::set<XY> new_transparency_mask;
 
@@ -970,7 +1135,7 @@ SlpFramePtr SlpFrame::mirrorX(void)
         new_transparency_mask.emplace(pixel);
     }
 
-    new_data.transparency_mask = std::vector<XY>(new_transparency_mask.begin(), new_transparency_mask.end());
+    new_data.transparency_mask = SlpPixelMask<XY>(new_transparency_mask.begin(), new_transparency_mask.end());
 
     std::set<PlayerColorXY> new_player_color_mask;
 
@@ -979,7 +1144,7 @@ SlpFramePtr SlpFrame::mirrorX(void)
         new_player_color_mask.emplace(pixel);
     }
 
-    new_data.player_color_mask = std::vector<PlayerColorXY>(new_player_color_mask.begin(), new_player_color_mask.end());
+    new_data.player_color_mask = SlpPixelMask<PlayerColorXY>(new_player_color_mask.begin(), new_player_color_mask.end());
 
     return mirrored;
 }
@@ -39,6 +39,8 @@ Logger &SlpTemplateFile::log = Logger::getLogger("genie.SlpTemplate");
 //------------------------------------------------------------------------------
 void SlpTemplateFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_SLP_TEMPLATE);
+
     if (isOperation(OP_READ) && !loaded_) {
         loadFile();
     } else if (isOperation(OP_WRITE)) { // && loaded_)
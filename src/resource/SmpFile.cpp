@@ -6,6 +6,8 @@ Logger &SmpFile::log = Logger::getLogger("genie.SmpFile");
 
 void SmpFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_SMP);
+
     serialize(m_header);
     if (getOperation() == OP_READ && m_header != smpHeader) {
         // todo throw exception
@@ -6,6 +6,8 @@ Logger &SmxFile::log = Logger::getLogger("genie.SmxFile");
 
 void SmxFile::serializeObject()
 {
+    IoStats::Scope ioScope(IoStats::IO_SMX);
+
     serialize(m_header);
     if (getOperation() == OP_READ && m_header != defaultHeader) {
         // todo throw exception
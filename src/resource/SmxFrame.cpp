@@ -1,7 +1,9 @@
 #include "genie/resource/SmxFrame.h"
+#include "genie/resource/PaletteExpander.h"
 
 #include <limits.h>
 #include <cmath>
+#include <array>
 
 namespace genie {
 
@@ -50,6 +52,25 @@ void SmxFrame::serializeObject()
 
 }
 
+void SmxFrame::decodeRgba(const PalFile &palette, uint32_t *pixels, size_t stride) const
+{
+    std::array<uint32_t, 1024> colors;
+    PaletteExpander::fillTable(palette.colors_, colors.data(), colors.size());
+
+    const size_t width = m_normalHeader.width;
+
+    for (size_t y = 0; y < m_normalHeader.height; y++) {
+        uint32_t *row = pixels + y * stride;
+        PaletteExpander::expand(&m_pixels[y * width], width, colors.data(), row);
+
+        for (size_t x = 0; x < width; x++) {
+            if (!m_mask[y * width + x]) {
+                row[x] = 0;
+            }
+        }
+    }
+}
+
 void SmxFrame::serializeLayerHeader(SmxFrame::LayerHeader &header)
 {
     serialize(header.width);
@@ -131,11 +152,12 @@ void SmxFrame::readNormalLayer()
             assert((x) + m_normalHeader.rowEdges[y].padRight == m_normalHeader.width);
             do {
                 y++;
-                x = m_normalHeader.rowEdges[y].padLeft;
-            } while (y < m_normalHeader.rowEdges.size()  && x == 0xFFFF);
+            } while (y < m_normalHeader.rowEdges.size() && m_normalHeader.rowEdges[y].padLeft == 0xFFFF);
 
             if (y >= m_normalHeader.rowEdges.size()) {
                 x = 0;
+            } else {
+                x = m_normalHeader.rowEdges[y].padLeft;
             }
             break;
         }
@@ -23,15 +23,12 @@
 
 #include "genie/util/Logger.h"
 
+#include <algorithm>
+#include <cstring>
 #include <math.h>
 
 namespace genie {
 
-std::string ISerializable::scn_ver = "0.00";
-float ISerializable::scn_plr_data_ver = 0.f;
-float ISerializable::scn_internal_ver = 0.f;
-double ISerializable::scn_trigger_ver = 0.0;
-
 Logger &ScnFile::log = Logger::getLogger("genie.ScnFile");
 
 
@@ -39,35 +36,61 @@ Logger &ScnFile::log = Logger::getLogger("genie.ScnFile");
 ScnFile::ScnFile() :
     IFile(), compressor_(this)
 {
-    scn_internal_ver = 0.f;
 }
 
-void ScnFile::extractRaw(const char *from, const char *to)
+//------------------------------------------------------------------------------
+void ScnFile::setThreadCount(size_t threadCount)
 {
-    std::ifstream ifs;
-    std::ofstream ofs;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
 
-    ifs.open(from, std::ios::binary);
-    ofs.open(to, std::ios::binary);
+    threadCount_ = threadCount;
+}
 
-    char version[4];
-    ifs.read(version, 4);
-    ofs.write(version, 4);
+//------------------------------------------------------------------------------
+size_t ScnFile::getThreadCount(void) const
+{
+    return threadCount_;
+}
 
-    uint32_t headerLen;
+//------------------------------------------------------------------------------
+void ScnFile::setCompressionLevel(int level)
+{
+    compressor_.setCompressionLevel(level);
+}
 
-    ifs.read(reinterpret_cast<char *>(&headerLen), 4);
-    ofs.write(reinterpret_cast<char *>(&headerLen), 4);
+//------------------------------------------------------------------------------
+int ScnFile::getCompressionLevel(void) const
+{
+    return compressor_.getCompressionLevel();
+}
 
-    std::vector<char> header(headerLen);
+//------------------------------------------------------------------------------
+void ScnFile::extractRaw(const char *from, const char *to,
+                         const DecompressOptions &options)
+{
+    std::ifstream ifs(from, std::ios::binary);
+
+    if (ifs.fail()) {
+        throw std::ios_base::failure("Can't read file \"" + std::string(from) + "\"");
+    }
+
+    // Version and header length, followed by the header.
+    std::string header(8, '\0');
+    ifs.read(&header[0], 8);
+
+    uint32_t headerLen = 0;
+    memcpy(&headerLen, &header[4], sizeof(headerLen));
 
-    ifs.read(header.data(), headerLen);
-    ofs.write(header.data(), headerLen);
+    header.resize(8 + headerLen);
+    ifs.read(&header[8], headerLen);
 
-    Compressor::decompress(ifs, ofs);
+    if (!ifs) {
+        throw std::ios_base::failure("Can't read header of \"" + std::string(from) + "\"");
+    }
 
-    ifs.close();
-    ofs.close();
+    Compressor::decompress(ifs, to, options, header);
 }
 
 //------------------------------------------------------------------------------
@@ -133,6 +156,17 @@ void ScnFile::serializeObject(void)
     serialize<int32_t>(victoryType);
     serialize<uint32_t>(enabledPlayerCount);
 
+    if (isOperation(OP_WRITE) && threadCount_ > 1) {
+        // The calling thread is one of them.
+        if (!threadPool_ || threadPool_->threadCount() != threadCount_ - 1) {
+            threadPool_ = std::make_unique<ThreadPool>(threadCount_ - 1);
+        }
+
+        compressor_.setThreadPool(threadPool_.get());
+    } else {
+        compressor_.setThreadPool(nullptr);
+    }
+
     compressor_.beginCompression();
 #if 0
     std::ofstream dump("/tmp/decompressed");
@@ -154,21 +188,21 @@ void ScnFile::serializeObject(void)
 
     serialize<ISerializable>(map);
 
-    if (scn_ver == "1.20" || scn_ver == "1.21") {
-        scn_internal_ver = 1.14f;
-    } else if (scn_ver == "1.17" || scn_ver == "1.18" || scn_ver == "1.19") {
-        scn_internal_ver = 1.13f;
-    } else if (scn_ver == "1.14" || scn_ver == "1.15" || scn_ver == "1.16") {
-        scn_internal_ver = 1.12f;
-    } else if (scn_ver == "1.22") {
-        scn_internal_ver = 1.15f;
+    if (context().scn_ver == "1.20" || context().scn_ver == "1.21") {
+        context().scn_internal_ver = 1.14f;
+    } else if (context().scn_ver == "1.17" || context().scn_ver == "1.18" || context().scn_ver == "1.19") {
+        context().scn_internal_ver = 1.13f;
+    } else if (context().scn_ver == "1.14" || context().scn_ver == "1.15" || context().scn_ver == "1.16") {
+        context().scn_internal_ver = 1.12f;
+    } else if (context().scn_ver == "1.22") {
+        context().scn_internal_ver = 1.15f;
     } else {
-        std::cerr << "unhandled version " << scn_ver << std::endl;
+        std::cerr << "unhandled version " << context().scn_ver << std::endl;
     }
 
     serializeSize<uint32_t>(playerUnitsCount, playerUnits.size());
 
-    if (scn_internal_ver > 1.06f) {
+    if (context().scn_internal_ver > 1.06f) {
         serialize(playerResources, 8);
     } else {
         // A lot of data is read here.
@@ -180,22 +214,22 @@ void ScnFile::serializeObject(void)
     serialize<uint32_t>(playerCount2_);
     serialize(players, 8);
 
-    triggerVersion = scn_trigger_ver;
+    triggerVersion = context().scn_trigger_ver;
     serialize<double>(triggerVersion);
-    scn_trigger_ver = triggerVersion;
+    context().scn_trigger_ver = triggerVersion;
 
-    if (scn_trigger_ver > 1.4f) {
+    if (context().scn_trigger_ver > 1.4f) {
         serialize<int8_t>(objectivesStartingState);
     }
 
     serializeSize<uint32_t>(numTriggers_, triggers.size());
     serialize(triggers, numTriggers_);
 
-    if (scn_trigger_ver > 1.3f) {
+    if (context().scn_trigger_ver > 1.3f) {
         serialize<int32_t>(triggerDisplayOrder, numTriggers_);
     }
 
-    if (scn_ver == "1.22" || scn_ver == "1.21" || scn_ver == "1.20" || scn_ver == "1.19" || scn_ver == "1.18") {
+    if (context().scn_ver == "1.22" || context().scn_ver == "1.21" || context().scn_ver == "1.20" || context().scn_ver == "1.19" || context().scn_ver == "1.18") {
         serialize<uint32_t>(includeFiles);
         serialize<uint32_t>(perErrorIncluded);
 
@@ -291,9 +325,9 @@ void ScnFile::serializeVersion(void)
     }
     }*/
 
-    version = scn_ver;
+    version = context().scn_ver;
     serialize(version, 4);
-    scn_ver = version;
+    context().scn_ver = version;
 }
 
 //------------------------------------------------------------------------------
@@ -326,9 +360,9 @@ void ScnMainPlayerData::serializePlayerDataVersion(void)
     }
     }*/
 
-    playerDataVersion = scn_plr_data_ver;
+    playerDataVersion = context().scn_plr_data_ver;
     serialize<float>(playerDataVersion);
-    scn_plr_data_ver = playerDataVersion;
+    context().scn_plr_data_ver = playerDataVersion;
 
     /*if (isOperation(OP_READ))
     {
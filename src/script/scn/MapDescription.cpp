@@ -31,11 +31,4 @@ void ScnMap::serializeObject(void)
 
     serialize(tiles, width * height);
 }
-
-void MapTile::serializeObject(void)
-{
-    serialize<uint8_t>(terrainID);
-    serialize<uint8_t>(elevation);
-    serialize<uint8_t>(unused);
-}
 } // namespace genie
@@ -24,8 +24,6 @@
 
 namespace genie {
 
-bool CombinedResources::playerInfo = false;
-
 ScnMainPlayerData::~ScnMainPlayerData()
 {
     delete bitmap;
@@ -36,27 +34,27 @@ void ScnMainPlayerData::serializeObject(void)
 {
     serializePlayerDataVersion();
 
-    if (scn_plr_data_ver > 1.13f) {
+    if (context().scn_plr_data_ver > 1.13f) {
         for (unsigned int i = 0; i < 16; ++i) {
             serialize(playerNames[i], 256); // 1.14 <-- this is read much later in AoE 1
         }
 
-        if (scn_plr_data_ver > 1.15f) {
+        if (context().scn_plr_data_ver > 1.15f) {
             serialize<uint32_t>(playerNamesStringTable, 16);
         }
 
-        CombinedResources::playerInfo = true;
+        context().scn_player_info = true;
         serialize(resourcesPlusPlayerInfo, 16);
     }
 
-    if (scn_plr_data_ver > 1.06f) {
+    if (context().scn_plr_data_ver > 1.06f) {
         serialize<uint8_t>(conquestVictory);
     }
 
     serialize<ISerializable>(timeline);
     serializeSizedString<uint16_t>(originalFileName, false);
 
-    if (scn_plr_data_ver > 1.15f) {
+    if (context().scn_plr_data_ver > 1.15f) {
         serialize<uint32_t>(instructionsStringTable);
         serialize<uint32_t>(hintsStringTable);
         serialize<uint32_t>(victoryStringTable);
@@ -64,24 +62,24 @@ void ScnMainPlayerData::serializeObject(void)
         serialize<uint32_t>(historyStringTable);
     }
 
-    if (scn_plr_data_ver > 1.21f) {
+    if (context().scn_plr_data_ver > 1.21f) {
         serialize<uint32_t>(scoutsStringTable);
     }
 
     serializeSizedString<uint16_t>(instructions, false);
 
-    if (scn_plr_data_ver > 1.1f) {
+    if (context().scn_plr_data_ver > 1.1f) {
         serializeSizedString<uint16_t>(hints, false);
         serializeSizedString<uint16_t>(victory, false);
         serializeSizedString<uint16_t>(loss, false);
         serializeSizedString<uint16_t>(history, false);
     }
 
-    if (scn_plr_data_ver > 1.21f) {
+    if (context().scn_plr_data_ver > 1.21f) {
         serializeSizedString<uint16_t>(scouts, false);
     }
 
-    if (scn_plr_data_ver < 1.03f) {
+    if (context().scn_plr_data_ver < 1.03f) {
         serializeSizedString<uint16_t>(oldFilename1, false);
         serializeSizedString<uint16_t>(oldFilename2, false);
         serializeSizedString<uint16_t>(oldFilename3, false);
@@ -91,120 +89,120 @@ void ScnMainPlayerData::serializeObject(void)
     serializeSizedString<uint16_t>(victoryCinematicFilename, false);
     serializeSizedString<uint16_t>(lossCinematicFilename, false);
 
-    if (scn_plr_data_ver > 1.08f) {
+    if (context().scn_plr_data_ver > 1.08f) {
         serializeSizedString<uint16_t>(backgroundFilename, false);
     }
 
-    if (scn_plr_data_ver > 1.0f) {
+    if (context().scn_plr_data_ver > 1.0f) {
         serializeBitmap();
     }
 
     serializeSizedStrings<uint16_t>(aiNames, 16, false);
     serializeSizedStrings<uint16_t>(cityNames, 16, false);
 
-    if (scn_plr_data_ver > 1.07f) {
+    if (context().scn_plr_data_ver > 1.07f) {
         serializeSizedStrings<uint16_t>(personalityNames, 16, false);
     }
 
     serialize(aiFiles, 16);
 
-    if (scn_plr_data_ver > 1.1f) {
+    if (context().scn_plr_data_ver > 1.1f) {
         serialize<uint8_t>(aiTypes, 16);
     }
 
-    if (scn_plr_data_ver > 1.01f) {
+    if (context().scn_plr_data_ver > 1.01f) {
         serialize<uint32_t>(separator_);
     }
 
     // <- here actually switches the reading function in exe
 
-    if (scn_plr_data_ver < 1.14f) {
+    if (context().scn_plr_data_ver < 1.14f) {
         for (unsigned int i = 0; i < 16; ++i) {
             serialize(playerNames[i], 256);
         }
 
         serialize(resourcesPlusPlayerInfo, 16);
     } else {
-        CombinedResources::playerInfo = false;
+        context().scn_player_info = false;
         serialize(resourcesPlusPlayerInfo, 16);
     }
 
-    if (scn_plr_data_ver > 1.01f) {
+    if (context().scn_plr_data_ver > 1.01f) {
         serialize<uint32_t>(separator_);
     }
 
     serialize<ISerializable>(victoryConditions);
     serialize<ISerializable>(diplomacy);
 
-    if (scn_plr_data_ver > 1.01f) {
+    if (context().scn_plr_data_ver > 1.01f) {
         serialize<uint32_t>(separator_);
     }
 
-    serialize<uint32_t>(alliedVictory, scn_plr_data_ver < 1.02f ? 16 * 16 : 16);
+    serialize<uint32_t>(alliedVictory, context().scn_plr_data_ver < 1.02f ? 16 * 16 : 16);
 
-    if (scn_plr_data_ver > 1.22f) {
+    if (context().scn_plr_data_ver > 1.22f) {
         serialize<uint32_t>(unused1);
     }
 
-    if (scn_plr_data_ver > 1.03f) {
+    if (context().scn_plr_data_ver > 1.03f) {
         serialize<ISerializable>(disables);
     }
 
-    if (scn_plr_data_ver > 1.04f) {
+    if (context().scn_plr_data_ver > 1.04f) {
         serialize<uint32_t>(unused1);
     }
 
-    if (scn_plr_data_ver > 1.11f) {
+    if (context().scn_plr_data_ver > 1.11f) {
         serialize<uint32_t>(unused2);
         serialize<uint32_t>(allTechs);
     }
 
-    if (scn_plr_data_ver > 1.05f) {
+    if (context().scn_plr_data_ver > 1.05f) {
         serialize<int32_t>(startingAge, 16);
     }
 
-    if (scn_plr_data_ver > 1.01f) {
+    if (context().scn_plr_data_ver > 1.01f) {
         serialize<uint32_t>(separator_);
     }
 
-    if (scn_plr_data_ver > 1.18f) {
+    if (context().scn_plr_data_ver > 1.18f) {
         serialize<int32_t>(player1CameraX);
         serialize<int32_t>(player1CameraY);
     }
 
-    if (scn_plr_data_ver > 1.2f) {
+    if (context().scn_plr_data_ver > 1.2f) {
         serialize<int32_t>(aiType);
     }
 
-    if (scn_plr_data_ver > 1.23f) {
+    if (context().scn_plr_data_ver > 1.23f) {
         serialize<uint8_t>(aiTypes, 16);
     }
 }
 
 void CombinedResources::serializeObject(void)
 {
-    if (playerInfo || scn_plr_data_ver < 1.14f) {
+    if (context().scn_player_info || context().scn_plr_data_ver < 1.14f) {
         serialize<uint32_t>(enabled);
     }
 
-    if (!playerInfo || scn_plr_data_ver < 1.14f) {
+    if (!context().scn_player_info || context().scn_plr_data_ver < 1.14f) {
         serialize<uint32_t>(gold);
         serialize<uint32_t>(wood);
         serialize<uint32_t>(food);
         serialize<uint32_t>(stone);
     }
 
-    if (playerInfo || scn_plr_data_ver < 1.14f) {
+    if (context().scn_player_info || context().scn_plr_data_ver < 1.14f) {
         serialize<uint32_t>(isHuman);
         serialize<uint32_t>(civilizationID);
         serialize<uint32_t>(unknown1);
     }
 
-    if (!playerInfo && scn_plr_data_ver > 1.16f) {
+    if (!context().scn_player_info && context().scn_plr_data_ver > 1.16f) {
         serialize<uint32_t>(ore);
         serialize<uint32_t>(goods);
 
-        if (scn_plr_data_ver > 1.23f) {
+        if (context().scn_plr_data_ver > 1.23f) {
             serialize<uint32_t>(goods);
         }
     }
@@ -288,7 +286,7 @@ void AiFile::serializeObject(void)
     serializeSize<uint32_t>(aiFilenameSize, aiFilename, true);
     serializeSize<uint32_t>(cityFileSize, cityFilename, true);
 
-    if (scn_plr_data_ver > 1.07f) {
+    if (context().scn_plr_data_ver > 1.07f) {
         serializeSize<uint32_t>(perFileSize, perFilename, true);
     }
 
@@ -296,7 +294,7 @@ void AiFile::serializeObject(void)
     serialize(aiFilename, aiFilenameSize);
     serialize(cityFilename, cityFileSize);
 
-    if (scn_plr_data_ver > 1.07f) {
+    if (context().scn_plr_data_ver > 1.07f) {
         serialize(perFilename, perFileSize);
     }
 }
@@ -313,7 +311,7 @@ void ScnVictory::serializeObject(void)
     }
     serialize<uint32_t>(allConditionsRequired);
 
-    if (scn_plr_data_ver > 1.12f) {
+    if (context().scn_plr_data_ver > 1.12f) {
         serialize<uint32_t>(victoryMode);
         serialize<uint32_t>(scoreRequired);
         serialize<uint32_t>(timeForTimedGame);
@@ -346,17 +344,17 @@ void ScnDiplomacy::serializeObject(void)
 
 void ScnDisables::serializeObject(void)
 {
-    if (scn_plr_data_ver > 1.17f) {
+    if (context().scn_plr_data_ver > 1.17f) {
         serialize<uint32_t>(numDisabledTechs, 16);
     }
 
-    serialize<uint32_t>(disabledTechs, 16, scn_plr_data_ver < 1.04f ? 20 : scn_plr_data_ver < 1.3f ? 30 : 60);
+    serialize<uint32_t>(disabledTechs, 16, context().scn_plr_data_ver < 1.04f ? 20 : context().scn_plr_data_ver < 1.3f ? 30 : 60);
 
-    if (scn_plr_data_ver > 1.17f) {
+    if (context().scn_plr_data_ver > 1.17f) {
         serialize<uint32_t>(numDisabledUnits, 16);
-        serialize<uint32_t>(disabledUnits, 16, scn_plr_data_ver < 1.3f ? 30 : 60);
+        serialize<uint32_t>(disabledUnits, 16, context().scn_plr_data_ver < 1.3f ? 30 : 60);
         serialize<uint32_t>(numDisabledBuildings, 16);
-        serialize<uint32_t>(disabledBuildings, 16, scn_plr_data_ver < 1.3f ? 20 : 60);
+        serialize<uint32_t>(disabledBuildings, 16, context().scn_plr_data_ver < 1.3f ? 20 : 60);
     }
 }
 
@@ -371,14 +369,14 @@ void ScnMorePlayerData::serializeObject(void)
     serializeSize<uint16_t>(playerCount_, diplomacy1.size());
     serialize<uint8_t>(diplomacy1, playerCount_);
 
-    if (scn_internal_ver >= 1.08) {
+    if (context().scn_internal_ver >= 1.08) {
         serialize<uint32_t>(diplomacy2, playerCount_);
     }
 
     serialize<uint32_t>(playerColor);
 
     // victory condition version
-    if (scn_internal_ver >= 1.09) {
+    if (context().scn_internal_ver >= 1.09) {
         serialize<float>(victoryConditionVersion);
     } else {
         victoryConditionVersion = 0;
@@ -413,7 +411,7 @@ void ScnMorePlayerData::serializeObject(void)
 //        printf("unknown 2: %d\n", unknown2);
     }
 
-    if (scn_internal_ver > 1.14f) {
+    if (context().scn_internal_ver > 1.14f) {
         serialize<int32_t>(playerID);
     }
 }
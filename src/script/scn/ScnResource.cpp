@@ -32,20 +32,20 @@ void ScnPlayerResources::serializeObject(void)
     serialize<float>(gold);
     serialize<float>(stone);
 
-    if (scn_internal_ver > 1.12f) {
+    if (context().scn_internal_ver > 1.12f) {
         serialize<float>(ore);
 
         // this seems wrong, 1.3 is way too high, is always true?
-        if (scn_internal_ver < 1.3f) {
+        if (context().scn_internal_ver < 1.3f) {
             serialize<float>(goods);
         }
     }
 
-    if (scn_internal_ver > 1.13f) {
+    if (context().scn_internal_ver > 1.13f) {
         serialize<float>(popLimit); // game forces range from 25 to 200, defaults to 75
     }
 
-    if (scn_internal_ver > 1.14f) {
+    if (context().scn_internal_ver > 1.14f) {
         serialize<uint32_t>(playerId);
     }
 }
@@ -80,21 +80,21 @@ void ScnUnit::serializeObject(void)
     serialize<uint8_t>(state);
     serialize<float>(rotation);
 
-    if (scn_ver != "1.14") {
+    if (context().scn_ver != "1.14") {
         serialize<uint16_t>(initAnimationFrame);
     }
 
     serialize<int32_t>(garrisonedInID);
 
     if (!garrisonedInID && (
-                scn_ver == "1.13" ||
-                scn_ver == "1.14" ||
-                scn_ver == "1.15" ||
-                scn_ver == "1.16" ||
-                scn_ver == "1.17" ||
-                scn_ver == "1.18" ||
-                scn_ver == "1.19" ||
-                scn_ver == "1.20")) {
+                context().scn_ver == "1.13" ||
+                context().scn_ver == "1.14" ||
+                context().scn_ver == "1.15" ||
+                context().scn_ver == "1.16" ||
+                context().scn_ver == "1.17" ||
+                context().scn_ver == "1.18" ||
+                context().scn_ver == "1.19" ||
+                context().scn_ver == "1.20")) {
         garrisonedInID = -1;
     }
 }
@@ -32,7 +32,7 @@ void Trigger::serializeObject(void)
     serialize<int8_t>(isObjective);
     serialize<int32_t>(descriptionOrder);
 
-    if (scn_trigger_ver > 1.5f) {
+    if (context().scn_trigger_ver > 1.5f) {
         serialize<int32_t>(startingTime);
     }
 
@@ -41,14 +41,14 @@ void Trigger::serializeObject(void)
     serializeSize<int32_t>(numEffects_, effects.size());
     serialize(effects, numEffects_);
 
-    if (scn_trigger_ver > 1.2f) {
+    if (context().scn_trigger_ver > 1.2f) {
         serialize<int32_t>(effectDisplayOrder, numEffects_);
     }
 
     serializeSize<int32_t>(numConditions_, conditions.size());
     serialize(conditions, numConditions_);
 
-    if (scn_trigger_ver > 1.2f) {
+    if (context().scn_trigger_ver > 1.2f) {
         serialize<int32_t>(conditionDisplayOrder, numConditions_);
     }
 }
@@ -57,7 +57,7 @@ void TriggerCondition::serializeObject(void)
 {
     serialize<int32_t>(type);
 
-    if (scn_trigger_ver > 1.0f) {
+    if (context().scn_trigger_ver > 1.0f) {
         if (isOperation(OP_WRITE)) { // Automatic compression.
             usedVariables = 16;
             int32_t *browser = &aiSignal;
@@ -85,7 +85,7 @@ void TriggerEffect::serializeObject(void)
 {
     serialize<int32_t>(type);
 
-    if (scn_trigger_ver > 1.0f) {
+    if (context().scn_trigger_ver > 1.0f) {
         if (isOperation(OP_WRITE)) { // Automatic compression.
             usedVariables = 23;
             int32_t *browser = &instructionPanel;
@@ -110,7 +110,7 @@ void TriggerEffect::serializeObject(void)
     serializeForcedString<int32_t>(message);
     serializeForcedString<int32_t>(soundFile);
 
-    if (scn_trigger_ver > 1.1f && usedVariables >= 5 && setObjects > 0) {
+    if (context().scn_trigger_ver > 1.1f && usedVariables >= 5 && setObjects > 0) {
         serialize<int32_t>(selectedUnits, setObjects);
     }
 }
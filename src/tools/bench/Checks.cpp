@@ -0,0 +1,333 @@
+/*
+    Round trip checks of the fast paths against the plain ones
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Checks.h"
+
+#include "Fixtures.h"
+
+#include "genie/dat/DatPatch.h"
+#include "genie/resource/PaletteExpander.h"
+#include "genie/resource/SmpFrame.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace bench {
+
+using namespace genie;
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// Prints the result of a check.
+///
+/// @return 1 if it failed, 0 otherwise
+//
+size_t report(const char *check, const std::string &labels, bool passed)
+{
+    std::printf("{\"check\": \"%s\", %s\"passed\": %s}\n", check, labels.c_str(),
+                passed ? "true" : "false");
+    std::fflush(stdout);
+
+    return passed ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------
+std::string readFile(const std::string &fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+
+    return content.str();
+}
+
+//------------------------------------------------------------------------------
+/// Saves the DAT file and inflates it again, so the uncompressed bytes are
+/// compared and the compressed stream is checked too.
+//
+std::string savedBytes(DatFile &dat, const std::string &fileName)
+{
+    const std::string rawFileName = fileName + ".raw";
+
+    dat.saveAs(fileName.c_str());
+
+    DatFile extractor;
+    extractor.extractRaw(fileName.c_str(), rawFileName.c_str());
+
+    return readFile(rawFileName);
+}
+
+//------------------------------------------------------------------------------
+/// Changes the DAT file like an editor would: units, names, removed techs and
+/// added sounds.
+//
+void modify(DatFile &dat, GameVersion gv)
+{
+    dat.Civs.back().Units.back().HitPoints = 1234;
+    dat.Civs.front().Units.front().Name = "Longer name of the first unit";
+    dat.Civs.front().Name = "Changed";
+    dat.Civs.back().Units.pop_back();
+    dat.Civs.back().UnitPointers.pop_back();
+    dat.Techs.pop_back();
+    dat.Graphics.front().Name = "g";
+    dat.Sounds.emplace_back();
+    dat.Sounds.back().setGameVersion(gv);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+size_t checkDat(const std::string &directory, const char *game, GameVersion gv, size_t civCount,
+                size_t unitCount)
+{
+    const std::filesystem::path path(directory);
+    const std::string fileName = (path / "check.dat").string();
+    const std::string savedFileName = (path / "check_saved.dat").string();
+    const std::string snapshotFileName = (path / "check.snapshot").string();
+    const std::string labels = std::string("\"game\": \"") + game + "\", ";
+
+    {
+        DatFile dat;
+        fillDat(dat, gv, civCount, unitCount);
+        dat.saveAs(fileName.c_str());
+    }
+
+    DatFile plain;
+    plain.setGameVersion(gv);
+    plain.load(fileName);
+
+    const std::string expected = savedBytes(plain, savedFileName);
+    size_t failed = 0;
+
+    // The parallel load has to give the same objects as the sequential one.
+    for (size_t threadCount : { 2, 4, 8 }) {
+        DatFile dat;
+        dat.setGameVersion(gv);
+        dat.setThreadCount(threadCount);
+        dat.load(fileName);
+
+        failed += report("dat_load_parallel", labels, savedBytes(dat, savedFileName) == expected);
+
+        // Each thread deflates a part of the file, zlib has to read them as
+        // one stream.
+        dat.setCompressionLevel(9);
+        failed += report("dat_compress_parallel", labels, savedBytes(dat, savedFileName) == expected);
+    }
+
+    {
+        DatFile dat;
+        dat.setGameVersion(gv);
+        dat.setLoadMode(IFile::LOAD_MAPPED);
+        dat.load(fileName);
+
+        failed += report("dat_load_mapped", labels, savedBytes(dat, savedFileName) == expected);
+    }
+
+    for (size_t threadCount : { 1, 3 }) {
+        DatFile dat;
+        dat.setGameVersion(gv);
+        dat.setLazyLoading(true);
+        dat.setThreadCount(threadCount);
+        dat.load(fileName);
+        dat.getGraphics();
+        dat.getCiv(civCount - 1);
+
+        failed += report("dat_load_lazy", labels, savedBytes(dat, savedFileName) == expected);
+    }
+
+    {
+        DatFile dat;
+        dat.setGameVersion(gv);
+        dat.setLazyLoading(true);
+        dat.load(fileName);
+        dat.Civs.emplace_back();
+
+        bool thrown = false;
+
+        try {
+            dat.getCiv(0);
+        } catch (const std::logic_error &) {
+            thrown = true;
+        }
+
+        failed += report("dat_load_lazy_resized", labels, thrown);
+    }
+
+    {
+        std::filesystem::remove(snapshotFileName);
+
+        DatFile recording;
+        recording.setGameVersion(gv);
+        const bool recordingUsed = recording.loadWithSnapshot(fileName, snapshotFileName);
+
+        failed += report("dat_snapshot_write", labels,
+                         !recordingUsed && savedBytes(recording, savedFileName) == expected);
+
+        DatFile replaying;
+        replaying.setGameVersion(gv);
+        replaying.setLazyLoading(true);
+        const bool replayingUsed = replaying.loadWithSnapshot(fileName, snapshotFileName);
+
+        failed += report("dat_snapshot_read", labels,
+                         replayingUsed && savedBytes(replaying, savedFileName) == expected);
+    }
+
+    {
+        DatFile incremental;
+        incremental.setGameVersion(gv);
+        incremental.setIncrementalSaving(true);
+        incremental.load(fileName);
+
+        DatFile full;
+        full.setGameVersion(gv);
+        full.load(fileName);
+
+        for (DatFile *dat : { &incremental, &full }) {
+            dat->Civs.front().Units.back().HitPoints = 777;
+            dat->Civs.front().Units.back().Name = "Renamed unit";
+            dat->Graphics.back().Name = "Renamed graphic";
+        }
+
+        incremental.invalidateCiv(0);
+        incremental.invalidateSection(DatFile::SECTION_GRAPHICS);
+
+        failed += report("dat_save_incremental", labels,
+                         savedBytes(incremental, savedFileName) == savedBytes(full, savedFileName));
+
+        // Sections saved unchanged by the first save are reused by the second.
+        for (DatFile *dat : { &incremental, &full }) {
+            dat->Techs.front().Name = "Renamed tech";
+        }
+
+        incremental.invalidateSection(DatFile::SECTION_TECHS);
+
+        failed += report("dat_save_incremental_again", labels,
+                         savedBytes(incremental, savedFileName) == savedBytes(full, savedFileName));
+    }
+
+    {
+        DatFile base;
+        base.setGameVersion(gv);
+        base.load(fileName);
+
+        DatFile target;
+        target.setGameVersion(gv);
+        target.load(fileName);
+        modify(target, gv);
+
+        const std::string patched = savedBytes(target, savedFileName);
+        const std::string patchFileName = (path / "check.patch").string();
+
+        DatPatch created;
+        created.create(base, target);
+        created.saveAs(patchFileName.c_str());
+
+        DatPatch patch;
+        patch.load(patchFileName);
+
+        DatFile dat;
+        dat.setGameVersion(gv);
+        dat.load(fileName);
+        patch.apply(dat);
+
+        failed += report("dat_patch_apply", labels, savedBytes(dat, savedFileName) == patched);
+
+        DatFile lazy;
+        lazy.setGameVersion(gv);
+        lazy.setLazyLoading(true);
+        lazy.setIncrementalSaving(true);
+        lazy.load(fileName);
+        patch.apply(lazy);
+
+        failed += report("dat_patch_apply_lazy", labels, savedBytes(lazy, savedFileName) == patched);
+    }
+
+    return failed;
+}
+
+//------------------------------------------------------------------------------
+size_t checkPaletteExpander(void)
+{
+    const size_t maxCount = 40;
+    const uint8_t offset = 200;
+    // Written after the expanded colors, to see writes past count.
+    const uint32_t guard = 0xdeadbeef;
+
+    std::vector<uint32_t> colors(1024);
+    std::vector<uint8_t> indexes(maxCount);
+    std::vector<SmpPixel> pixels(maxCount);
+
+    for (size_t i = 0; i < colors.size(); i++) {
+        colors[i] = uint32_t(i * 2654435761u);
+    }
+
+    // Indexes from the whole range, so index + offset wraps for some of them.
+    for (size_t i = 0; i < maxCount; i++) {
+        indexes[i] = uint8_t(i * 37 + 11);
+        pixels[i] = { uint8_t(i * 53 + 7), uint8_t(i % 4), 0, 0 };
+    }
+
+    const PaletteExpander::Kernel fastest = PaletteExpander::getKernel();
+
+    auto expandAll = [&](std::vector<uint32_t> &expanded, std::vector<uint32_t> &expandedSmp) {
+        expanded.clear();
+        expandedSmp.clear();
+
+        for (size_t count = 0; count <= maxCount; count++) {
+            std::vector<uint32_t> rgba(count + 1, guard);
+            PaletteExpander::expand(indexes.data(), count, colors.data(), rgba.data(), offset);
+            expanded.insert(expanded.end(), rgba.begin(), rgba.end());
+
+            std::vector<uint32_t> smpRgba(count + 1, guard);
+            PaletteExpander::expand(pixels.data(), count, colors.data(), smpRgba.data());
+            expandedSmp.insert(expandedSmp.end(), smpRgba.begin(), smpRgba.end());
+        }
+    };
+
+    std::vector<uint32_t> expected, expectedSmp;
+    PaletteExpander::setKernel(PaletteExpander::KERNEL_SCALAR);
+    expandAll(expected, expectedSmp);
+
+    size_t failed = 0;
+
+    for (int kernel = 0; kernel < PaletteExpander::KERNEL_COUNT; kernel++) {
+        if (!PaletteExpander::setKernel(PaletteExpander::Kernel(kernel))) {
+            continue;
+        }
+
+        std::vector<uint32_t> expanded, expandedSmp;
+        expandAll(expanded, expandedSmp);
+
+        const std::string labels = std::string("\"kernel\": \"")
+            + PaletteExpander::getKernelName(PaletteExpander::Kernel(kernel)) + "\", ";
+
+        failed += report("palette_expand_8bit", labels, expanded == expected);
+        failed += report("palette_expand_smp", labels, expandedSmp == expectedSmp);
+    }
+
+    PaletteExpander::setKernel(fastest);
+
+    return failed;
+}
+
+} // namespace bench
@@ -0,0 +1,54 @@
+/*
+    Round trip checks of the fast paths against the plain ones
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_BENCH_CHECKS_H
+#define GENIE_BENCH_CHECKS_H
+
+#include "genie/Types.h"
+
+#include <string>
+
+namespace bench {
+
+//------------------------------------------------------------------------------
+/// Checks that the faster ways to load, save and patch a generated DAT file
+/// give the same bytes as a plain load and save. Prints one JSON object per
+/// check.
+///
+/// @param directory where the files of the checks are written
+/// @param game name of the game printed with the results
+/// @param civCount number of civilizations of the generated file
+/// @param unitCount number of units per civilization of the generated file
+/// @return number of failed checks
+//
+size_t checkDat(const std::string &directory, const char *game, genie::GameVersion gv,
+                size_t civCount, size_t unitCount);
+
+//------------------------------------------------------------------------------
+/// Checks that each palette kernel the CPU has expands 8-bit indexes, with a
+/// player offset wrapping around at 256, and SMP pixels like the scalar one,
+/// for every count from 0 to 40, so all tails of the vector loops are run.
+/// Prints one JSON object per kernel.
+///
+/// @return number of failed checks
+//
+size_t checkPaletteExpander(void);
+
+} // namespace bench
+
+#endif // GENIE_BENCH_CHECKS_H
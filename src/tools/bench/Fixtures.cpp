@@ -0,0 +1,821 @@
+/*
+    Generated input files for genieutils_bench
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Fixtures.h"
+
+#include "genie/resource/SlpFrame.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace bench {
+
+using namespace genie;
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// Xorshift generator, so the fixtures are the same on all platforms.
+//
+class Random
+{
+public:
+    explicit Random(uint32_t seed) :
+        state_(seed)
+    {
+    }
+
+    uint32_t next(void)
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    /// Number from 0 to count - 1
+    uint32_t below(uint32_t count)
+    {
+        return next() % count;
+    }
+
+private:
+    uint32_t state_;
+};
+
+//------------------------------------------------------------------------------
+/// Appends little endian values to a file.
+//
+class Writer
+{
+public:
+    std::vector<uint8_t> data;
+
+    template <typename T>
+    void put(T value)
+    {
+        const size_t pos = data.size();
+        data.resize(pos + sizeof(T));
+        std::memcpy(&data[pos], &value, sizeof(T));
+    }
+
+    template <typename T>
+    void putAt(size_t pos, T value)
+    {
+        std::memcpy(&data[pos], &value, sizeof(T));
+    }
+
+    /// Writes str padded with zeros to len bytes.
+    void putString(const std::string &str, size_t len)
+    {
+        const size_t pos = data.size();
+        data.resize(pos + len, 0);
+        std::memcpy(&data[pos], str.data(), std::min(len, str.size()));
+    }
+
+    void putBytes(const std::vector<uint8_t> &bytes)
+    {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    uint32_t pos(void) const
+    {
+        return uint32_t(data.size());
+    }
+};
+
+//------------------------------------------------------------------------------
+/// Transparent pixels on the left of each row of a round silhouette, or
+/// width for rows above and below it.
+//
+std::vector<uint32_t> silhouette(uint32_t width, uint32_t height, uint32_t margin)
+{
+    std::vector<uint32_t> edges(height, width);
+    const float radius = (height - 2 * margin) / 2.f;
+
+    for (uint32_t row = margin; row < height - margin; row++) {
+        const float dy = (row + 0.5f - height / 2.f) / radius;
+        const float halfWidth = (width / 2.f) * std::max(0.f, 1.f - dy * dy);
+        edges[row] = std::min(width / 2 - 1, uint32_t(width / 2.f - halfWidth));
+    }
+
+    return edges;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeSlpRow(Random &random, uint32_t count, bool is32bit)
+{
+    std::vector<uint8_t> commands;
+
+    const auto putColor = [&]() {
+        if (is32bit) {
+            const uint32_t bgra = 0xFF000000 | (random.next() & 0xFFFFFF);
+            commands.push_back(bgra);
+            commands.push_back(bgra >> 8);
+            commands.push_back(bgra >> 16);
+            commands.push_back(bgra >> 24);
+        } else {
+            commands.push_back(16 + random.below(200));
+        }
+    };
+
+    // 8 bit frames are outlined on both sides, like units drawn behind
+    // buildings. 32 bit frames only have colours, like interface graphics.
+    const auto putBorder = [&]() {
+        if (is32bit) {
+            commands.push_back(SlpFrame::LesserBlockCopy | (1 << 2));
+            putColor();
+        } else {
+            commands.push_back(SlpFrame::OutlinePlayerColor);
+        }
+    };
+
+    putBorder();
+    count -= 2;
+
+    while (count > 0) {
+        const uint32_t pixels = 1 + random.below(std::min(count, 15u));
+        const uint32_t kind = random.below(is32bit ? 8 : 10);
+
+        if (kind < 5) {
+            commands.push_back(SlpFrame::LesserBlockCopy | (pixels << 2));
+
+            for (uint32_t i = 0; i < pixels; i++) {
+                putColor();
+            }
+        } else if (kind < 7) {
+            commands.push_back(SlpFrame::FillColor | (pixels << 4));
+            putColor();
+        } else if (kind < 8 && !is32bit) {
+            commands.push_back(SlpFrame::CopyAndTransform | (pixels << 4));
+
+            for (uint32_t i = 0; i < pixels; i++) {
+                commands.push_back(random.below(8));
+            }
+        } else if (kind < 9 && !is32bit) {
+            commands.push_back(SlpFrame::Shadow | (pixels << 4));
+        } else {
+            commands.push_back(SlpFrame::LesserSkip | (pixels << 2));
+        }
+
+        count -= pixels;
+    }
+
+    putBorder();
+    commands.push_back(SlpFrame::EndOfRow);
+
+    return commands;
+}
+
+//------------------------------------------------------------------------------
+/// Writes data as a raw deflate stream of stored blocks, see RFC 1951.
+//
+void putStoredDeflate(Writer &writer, const std::vector<uint8_t> &data)
+{
+    size_t pos = 0;
+
+    do {
+        const uint16_t len = uint16_t(std::min<size_t>(data.size() - pos, 0xFFFF));
+        const bool last = pos + len == data.size();
+
+        writer.put<uint8_t>(last ? 1 : 0);
+        writer.put<uint16_t>(len);
+        writer.put<uint16_t>(~len);
+        writer.data.insert(writer.data.end(), data.begin() + pos, data.begin() + pos + len);
+
+        pos += len;
+    } while (pos < data.size());
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+void fillDat(DatFile &dat, GameVersion gv, size_t civCount, size_t unitCount)
+{
+    static const int8_t unitTypes[] = { 10, 20, 30, 40, 50, 60, 70, 80 };
+
+    dat.setGameVersion(gv);
+
+    dat.FileVersion = gv >= GV_SWGB ? "VER 5.9" : "VER 5.7";
+    dat.TerrainsUsed1 = Terrain::getTerrainCount(gv);
+
+    dat.TerrainRestrictions.resize(20);
+    dat.FloatPtrTerrainTables.assign(dat.TerrainRestrictions.size(), 1);
+    dat.TerrainPassGraphicPointers.assign(dat.TerrainRestrictions.size(), 1);
+
+    for (size_t i = 0; i < dat.TerrainRestrictions.size(); i++) {
+        TerrainRestriction &restriction = dat.TerrainRestrictions[i];
+        restriction.PassableBuildableDmgMultiplier.assign(dat.TerrainsUsed1, float(i));
+        restriction.TerrainPassGraphics.resize(dat.TerrainsUsed1);
+    }
+
+    dat.PlayerColours.resize(16);
+
+    dat.Sounds.resize(400);
+
+    for (size_t i = 0; i < dat.Sounds.size(); i++) {
+        dat.Sounds[i].ID = i;
+        dat.Sounds[i].Items.resize(1 + i % 4);
+
+        for (SoundItem &item : dat.Sounds[i].Items) {
+            item.FileName = "sound" + std::to_string(i);
+        }
+    }
+
+    dat.Graphics.resize(5000);
+    dat.GraphicPointers.assign(dat.Graphics.size(), 1);
+
+    for (size_t i = 0; i < dat.Graphics.size(); i++) {
+        Graphic &graphic = dat.Graphics[i];
+        graphic.ID = i;
+        graphic.Name = "graphic" + std::to_string(i);
+        graphic.FileName = "file" + std::to_string(i);
+        graphic.Deltas.resize(i % 3);
+        graphic.AngleCount = 8;
+        graphic.FrameCount = 10;
+        graphic.AngleSoundsUsed = i % 5 == 0;
+
+        if (graphic.AngleSoundsUsed) {
+            graphic.AngleSounds.resize(graphic.AngleCount);
+        }
+
+        // Some graphics are left out, like in the game files.
+        if (i % 50 == 49) {
+            dat.GraphicPointers[i] = 0;
+        }
+    }
+
+    dat.TerrainBlock.TerrainBorders.resize(16);
+
+    for (TerrainBorder &border : dat.TerrainBlock.TerrainBorders) {
+        for (std::vector<FrameData> &frames : border.Borders) {
+            frames.resize(gv == GV_MIK ? 13 : 12);
+        }
+    }
+
+    dat.RandomMaps.Maps.resize(10);
+
+    for (MapInfo &map : dat.RandomMaps.Maps) {
+        map.MapLands.resize(5);
+        map.MapTerrains.resize(6);
+        map.MapUnits.resize(7);
+        map.MapElevations.resize(2);
+    }
+
+    dat.Effects.resize(800);
+
+    for (size_t i = 0; i < dat.Effects.size(); i++) {
+        dat.Effects[i].Name = "effect" + std::to_string(i);
+        dat.Effects[i].EffectCommands.resize(i % 6);
+    }
+
+    dat.UnitHeaders.resize(unitCount);
+
+    for (size_t i = 0; i < dat.UnitHeaders.size(); i++) {
+        dat.UnitHeaders[i].Exists = i % 2;
+
+        if (dat.UnitHeaders[i].Exists) {
+            dat.UnitHeaders[i].TaskList.resize(1 + i % 5);
+        }
+    }
+
+    dat.Civs.resize(civCount);
+
+    for (size_t c = 0; c < dat.Civs.size(); c++) {
+        Civ &civ = dat.Civs[c];
+        civ.Name = "civ" + std::to_string(c);
+        civ.Resources.assign(200, 1.f);
+        civ.Units.resize(unitCount);
+        civ.UnitPointers.assign(unitCount, 1);
+
+        for (size_t u = 0; u < unitCount; u++) {
+            if (u % 7 == 6) {
+                civ.UnitPointers[u] = 0;
+                continue;
+            }
+
+            Unit &unit = civ.Units[u];
+            unit.Type = unitTypes[u % 8];
+            unit.ID = u;
+            unit.HitPoints = 10 + u;
+            unit.Name = "unit" + std::to_string(u);
+            unit.DamageGraphics.resize(u % 3);
+            unit.ResourceStorages.resize(3);
+            unit.Combat.Attacks.resize(u % 4);
+            unit.Combat.Armours.resize(u % 3);
+        }
+    }
+
+    dat.Techs.resize(900);
+
+    for (size_t i = 0; i < dat.Techs.size(); i++) {
+        dat.Techs[i].Name = "tech" + std::to_string(i);
+        dat.Techs[i].EffectID = i;
+    }
+
+    dat.TechTree.TechTreeAges.resize(5);
+    dat.TechTree.BuildingConnections.resize(20);
+    dat.TechTree.UnitConnections.resize(60);
+    dat.TechTree.ResearchConnections.resize(80);
+
+    // Brings the added objects to the same version.
+    dat.setGameVersion(gv);
+}
+
+//------------------------------------------------------------------------------
+size_t countDatObjects(const DatFile &dat)
+{
+    size_t count = dat.Sounds.size() + dat.Graphics.size() + dat.Effects.size()
+                   + dat.UnitHeaders.size() + dat.Techs.size();
+
+    for (const Civ &civ : dat.Civs) {
+        count += civ.Units.size();
+    }
+
+    return count;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeSlp(uint32_t frameCount, uint32_t width, uint32_t height, bool is32bit)
+{
+    Random random(0x534C5020 + is32bit);
+    Writer writer;
+
+    writer.putString("2.0N", 4);
+    writer.put<uint32_t>(frameCount);
+    writer.putString("ArtDesk 1.00 SLP Writer", 24);
+
+    const size_t headers = writer.pos();
+    writer.data.resize(headers + 32 * frameCount, 0);
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        const std::vector<uint32_t> edges = silhouette(width, height, 1 + frame % 4);
+        std::vector<std::vector<uint8_t>> rows(height);
+
+        const uint32_t outlineTable = writer.pos();
+
+        for (uint32_t row = 0; row < height; row++) {
+            if (edges[row] == width) {
+                writer.put<uint16_t>(0x8000);
+                writer.put<uint16_t>(0x8000);
+                continue;
+            }
+
+            rows[row] = makeSlpRow(random, width - 2 * edges[row], is32bit);
+            writer.put<uint16_t>(edges[row]);
+            writer.put<uint16_t>(edges[row]);
+        }
+
+        const uint32_t commandTable = writer.pos();
+        uint32_t commandOffset = commandTable + 4 * height;
+
+        for (const std::vector<uint8_t> &commands : rows) {
+            writer.put<uint32_t>(commandOffset);
+            commandOffset += commands.size();
+        }
+
+        for (const std::vector<uint8_t> &commands : rows) {
+            writer.putBytes(commands);
+        }
+
+        const size_t header = headers + 32 * frame;
+        writer.putAt<uint32_t>(header, commandTable);
+        writer.putAt<uint32_t>(header + 4, outlineTable);
+        writer.putAt<uint32_t>(header + 8, 0);
+        writer.putAt<uint32_t>(header + 12, is32bit ? 0x07 : 0x18);
+        writer.putAt<uint32_t>(header + 16, width);
+        writer.putAt<uint32_t>(header + 20, height);
+        writer.putAt<int32_t>(header + 24, width / 2);
+        writer.putAt<int32_t>(header + 28, height * 3 / 4);
+    }
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeSmp(uint32_t frameCount, uint32_t width, uint32_t height)
+{
+    Random random(0x534D5024);
+    Writer writer;
+
+    writer.putString("SMP$", 4);
+    writer.put<int32_t>(0x0B);
+    writer.put<int32_t>(frameCount);
+    writer.put<int32_t>(1);
+    writer.put<int32_t>(frameCount);
+    writer.put<int32_t>(0);
+    const size_t sizePos = writer.pos();
+    writer.put<int32_t>(0);
+    writer.put<int32_t>(1);
+    writer.putString("", 32);
+
+    // The library reads the frame headers and row edges one after another,
+    // the commands of all frames follow them.
+    std::vector<size_t> commandTables;
+    std::vector<std::vector<uint32_t>> frameEdges;
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        const std::vector<uint32_t> edges = silhouette(width, height, 1 + frame % 4);
+        const size_t header = writer.pos();
+
+        writer.put<uint32_t>(width);
+        writer.put<uint32_t>(height);
+        writer.put<int32_t>(width / 2);
+        writer.put<int32_t>(height * 3 / 4);
+        writer.put<uint32_t>(2);
+        writer.put<uint32_t>(header + 32);
+        writer.put<uint32_t>(0);
+        writer.put<uint32_t>(0x02);
+
+        for (uint32_t edge : edges) {
+            const uint16_t value = edge == width ? 0xFFFF : edge;
+            writer.put<uint16_t>(value);
+            writer.put<uint16_t>(value);
+        }
+
+        commandTables.push_back(header + 24);
+        frameEdges.push_back(edges);
+    }
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        writer.putAt<uint32_t>(commandTables[frame], writer.pos());
+
+        for (uint32_t edge : frameEdges[frame]) {
+            if (edge == width) {
+                continue;
+            }
+
+            for (uint32_t count = width - 2 * edge; count > 0;) {
+                const uint32_t pixels = 1 + random.below(std::min(count, 64u));
+                const bool playerColor = random.below(8) == 0;
+
+                writer.put<uint8_t>(((pixels - 1) << 2) | (playerColor ? 2 : 1));
+
+                for (uint32_t i = 0; i < pixels; i++) {
+                    writer.put<uint8_t>(random.below(256));
+                    writer.put<uint8_t>(random.below(4));
+                    writer.put<uint8_t>(0);
+                    writer.put<uint8_t>(0);
+                }
+
+                count -= pixels;
+            }
+
+            writer.put<uint8_t>(0x03);
+        }
+    }
+
+    writer.putAt<int32_t>(sizePos, writer.pos());
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeSmx(uint32_t frameCount, uint32_t width, uint32_t height)
+{
+    Random random(0x534D5058);
+    Writer writer;
+
+    writer.putString("SMPX", 4);
+    writer.put<uint16_t>(2);
+    writer.put<uint16_t>(frameCount);
+    const size_t sizePos = writer.pos();
+    writer.put<uint32_t>(0);
+    writer.put<uint32_t>(0);
+    writer.putString("", 16);
+
+    const auto putLayerHeader = [&](const std::vector<uint32_t> &edges) {
+        writer.put<uint16_t>(width);
+        writer.put<uint16_t>(height);
+        writer.put<uint16_t>(width / 2);
+        writer.put<uint16_t>(height * 3 / 4);
+        writer.put<uint32_t>(0);
+        writer.put<uint32_t>(0);
+
+        for (uint32_t edge : edges) {
+            writer.put<uint16_t>(edge);
+            writer.put<uint16_t>(edge);
+        }
+    };
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        // Without a margin, as the library needs the first row to have
+        // pixels.
+        const std::vector<uint32_t> edges = silhouette(width, height, 0);
+
+        writer.put<uint8_t>(0x07);
+        writer.put<uint8_t>(21);
+        writer.put<uint32_t>(0);
+
+        std::vector<uint8_t> commands;
+        size_t pixelCount = 0;
+
+        for (uint32_t edge : edges) {
+            for (uint32_t count = width - 2 * edge; count > 0;) {
+                const uint32_t pixels = 1 + random.below(std::min(count, 64u));
+                const bool playerColor = random.below(8) == 0;
+
+                commands.push_back(((pixels - 1) << 2) | (playerColor ? 2 : 1));
+                pixelCount += pixels;
+                count -= pixels;
+            }
+
+            commands.push_back(0x03);
+        }
+
+        // 4plus1: four palette indexes followed by their four sections
+        std::vector<uint8_t> pixelData;
+
+        for (size_t i = 0; i < pixelCount; i += 4) {
+            for (int j = 0; j < 4; j++) {
+                pixelData.push_back(random.below(256));
+            }
+
+            pixelData.push_back(random.below(256));
+        }
+
+        putLayerHeader(edges);
+        writer.put<uint32_t>(commands.size());
+        writer.put<uint32_t>(pixelData.size());
+        writer.putBytes(commands);
+        writer.putBytes(pixelData);
+
+        // Shadow layer, with one alpha value per drawn pixel
+        commands.clear();
+
+        for (uint32_t edge : edges) {
+            const uint32_t pixels = std::min(width - 2 * edge, 64u);
+            commands.push_back(((pixels - 1) << 2) | 1);
+
+            for (uint32_t i = 0; i < pixels; i++) {
+                commands.push_back(random.below(128));
+            }
+
+            commands.push_back(0x03);
+        }
+
+        putLayerHeader(edges);
+        writer.put<uint32_t>(commands.size());
+        writer.putBytes(commands);
+
+        // Outline layer
+        commands.clear();
+
+        for (uint32_t edge : edges) {
+            const uint32_t pixels = std::min(width - 2 * edge, 64u);
+            commands.push_back(((pixels - 1) << 2) | 1);
+            commands.push_back(0x03);
+        }
+
+        putLayerHeader(edges);
+        writer.put<uint32_t>(commands.size());
+        writer.putBytes(commands);
+    }
+
+    writer.putAt<uint32_t>(sizePos, writer.pos());
+    writer.putAt<uint32_t>(sizePos + 4, writer.pos());
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeBlendomatic(uint32_t modeCount, uint32_t tileCount, uint32_t pixelCount)
+{
+    Writer writer;
+
+    writer.put<uint32_t>(modeCount);
+    writer.put<uint32_t>(tileCount);
+
+    for (uint32_t mode = 0; mode < modeCount; mode++) {
+        writer.put<uint32_t>(pixelCount);
+
+        for (uint32_t tile = 0; tile < tileCount; tile++) {
+            writer.put<uint8_t>(tile % 5 != 0);
+        }
+
+        for (uint32_t pixel = 0; pixel < pixelCount; pixel++) {
+            writer.put<uint32_t>((pixel * 2654435761u) >> mode);
+        }
+
+        // Gradients in a different direction for each tile
+        for (uint32_t tile = 0; tile < tileCount; tile++) {
+            for (uint32_t pixel = 0; pixel < pixelCount; pixel++) {
+                writer.put<uint8_t>((pixel * (tile + 1) + mode * 16) % 129);
+            }
+        }
+    }
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeDrs(GameVersion gv, const std::vector<std::vector<uint8_t>> &slps,
+                             size_t wavCount)
+{
+    Random random(0x44525320);
+
+    std::vector<std::vector<uint8_t>> wavs(wavCount);
+
+    for (size_t i = 0; i < wavCount; i++) {
+        const uint32_t samples = 4000 + random.below(20000);
+
+        Writer wav;
+        wav.putString("RIFF", 4);
+        wav.put<uint32_t>(36 + samples);
+        wav.putString("WAVEfmt ", 8);
+        wav.put<uint32_t>(16);
+        wav.put<uint16_t>(1);
+        wav.put<uint16_t>(1);
+        wav.put<uint32_t>(22050);
+        wav.put<uint32_t>(22050);
+        wav.put<uint16_t>(1);
+        wav.put<uint16_t>(8);
+        wav.putString("data", 4);
+        wav.put<uint32_t>(samples);
+
+        for (uint32_t s = 0; s < samples; s++) {
+            wav.put<uint8_t>(128 + int(random.below(64)) - 32);
+        }
+
+        wavs[i] = std::move(wav.data);
+    }
+
+    const std::vector<std::pair<std::string, const std::vector<std::vector<uint8_t>> *>> tables = {
+        { " pls", &slps },
+        { " vaw", &wavs },
+    };
+
+    Writer writer;
+
+    writer.putString("Copyright (c) 1997 Ensemble Studios.\x1a", gv >= GV_SWGB ? 0x3C : 0x28);
+    writer.putString("1.00", 4);
+    writer.putString("tribe", 12);
+    writer.put<uint32_t>(tables.size());
+
+    uint32_t offset = writer.pos() + 4 + 12 * tables.size();
+    const uint32_t tablesStart = offset;
+
+    for (const auto &table : tables) {
+        offset += 12 * table.second->size();
+    }
+
+    writer.put<uint32_t>(offset);
+
+    uint32_t tableOffset = tablesStart;
+    uint32_t id = 1;
+
+    for (const auto &table : tables) {
+        writer.putString(table.first, 4);
+        writer.put<uint32_t>(tableOffset);
+        writer.put<uint32_t>(table.second->size());
+        tableOffset += 12 * table.second->size();
+    }
+
+    for (const auto &table : tables) {
+        for (const std::vector<uint8_t> &file : *table.second) {
+            writer.put<uint32_t>(id++);
+            writer.put<uint32_t>(offset);
+            writer.put<uint32_t>(file.size());
+            offset += file.size();
+        }
+    }
+
+    for (const auto &table : tables) {
+        for (const std::vector<uint8_t> &file : *table.second) {
+            writer.putBytes(file);
+        }
+    }
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+std::vector<uint8_t> makeScn(void)
+{
+    const std::string instructions = "Generated by genieutils_bench";
+
+    Writer writer;
+
+    writer.putString("1.21", 4);
+    writer.put<uint32_t>(20 + instructions.size() + 1);
+    writer.put<int32_t>(2);
+    writer.put<uint32_t>(0);
+    writer.put<uint32_t>(instructions.size() + 1);
+    writer.putString(instructions, instructions.size() + 1);
+    writer.put<int32_t>(0);
+    writer.put<uint32_t>(8);
+
+    // The compressed part starts with the next unit id and the player data
+    // version, all fields after them are zero.
+    std::vector<uint8_t> body(0x40000, 0);
+    const float playerDataVersion = 1.22f;
+    std::memcpy(&body[4], &playerDataVersion, sizeof(playerDataVersion));
+
+    putStoredDeflate(writer, body);
+
+    return writer.data;
+}
+
+//------------------------------------------------------------------------------
+void fillScn(ScnFile &scn, uint32_t mapSize, size_t unitCount, size_t triggerCount)
+{
+    Random random(0x53434E58);
+
+    scn.map.width = mapSize;
+    scn.map.height = mapSize;
+    scn.map.tiles.resize(mapSize * mapSize);
+
+    for (MapTile &tile : scn.map.tiles) {
+        tile.terrainID = random.below(8) == 0 ? random.below(40) : 0;
+        tile.elevation = random.below(3);
+    }
+
+    // Gaia and 8 players
+    scn.playerUnits.resize(9);
+    uint32_t spawnID = 0;
+
+    for (ScnPlayerUnits &player : scn.playerUnits) {
+        player.units.resize(unitCount);
+
+        for (ScnUnit &unit : player.units) {
+            unit.positionX = random.below(mapSize * 4) / 4.f;
+            unit.positionY = random.below(mapSize * 4) / 4.f;
+            unit.spawnID = spawnID++;
+            unit.objectID = 4 + random.below(900);
+            unit.state = ScnUnit::Placed;
+            unit.rotation = random.below(8) * 0.785398f;
+        }
+    }
+
+    scn.nextUnitID = spawnID;
+
+    scn.context().scn_trigger_ver = 1.6;
+    scn.triggers.resize(triggerCount);
+    scn.triggerDisplayOrder.resize(triggerCount);
+
+    for (size_t i = 0; i < triggerCount; i++) {
+        Trigger &trigger = scn.triggers[i];
+        trigger.startingState = 1;
+        trigger.looping = i % 10 == 0;
+        trigger.stringTableID = -1;
+        trigger.isObjective = 0;
+        trigger.descriptionOrder = i;
+        trigger.startingTime = 0;
+        trigger.name = "Trigger " + std::to_string(i);
+
+        trigger.conditions.resize(1 + i % 2);
+        trigger.conditionDisplayOrder.resize(trigger.conditions.size());
+
+        for (size_t c = 0; c < trigger.conditions.size(); c++) {
+            TriggerCondition &condition = trigger.conditions[c];
+            condition.type = 1 + random.below(20);
+            condition.amount = random.below(100);
+            condition.sourcePlayer = 1 + random.below(8);
+            trigger.conditionDisplayOrder[c] = c;
+        }
+
+        trigger.effects.resize(1 + i % 4);
+        trigger.effectDisplayOrder.resize(trigger.effects.size());
+
+        for (size_t e = 0; e < trigger.effects.size(); e++) {
+            TriggerEffect &effect = trigger.effects[e];
+            effect.type = 1 + random.below(29);
+            effect.sourcePlayer = 1 + random.below(8);
+            effect.location = { int32_t(random.below(mapSize)), int32_t(random.below(mapSize)) };
+            effect.message = e % 2 ? "Message " + std::to_string(i) : "";
+            trigger.effectDisplayOrder[e] = e;
+        }
+
+        scn.triggerDisplayOrder[i] = i;
+    }
+}
+
+//------------------------------------------------------------------------------
+void writeFile(const std::string &fileName, const std::vector<uint8_t> &data)
+{
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(data.data()), data.size());
+
+    if (!file) {
+        throw std::ios_base::failure("Can't write file \"" + fileName + "\"");
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,107 @@
+/*
+    Generated input files for genieutils_bench
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENIE_BENCH_FIXTURES_H
+#define GENIE_BENCH_FIXTURES_H
+
+#include "genie/dat/DatFile.h"
+#include "genie/script/ScnFile.h"
+
+#include <string>
+#include <vector>
+
+namespace bench {
+
+//------------------------------------------------------------------------------
+/// Fills a DAT file with generated data of a realistic shape, so the
+/// benchmarks don't depend on game files.
+///
+/// @param civCount number of civilizations
+/// @param unitCount number of units per civilization
+//
+void fillDat(genie::DatFile &dat, genie::GameVersion gv, size_t civCount, size_t unitCount);
+
+//------------------------------------------------------------------------------
+/// Number of objects in a loaded DAT file, counting sounds, graphics,
+/// effects, unit headers, the units of all civilizations and techs.
+//
+size_t countDatObjects(const genie::DatFile &dat);
+
+//------------------------------------------------------------------------------
+/// The generators below write the files byte by byte, as most of these
+/// formats can only be read by the library. The content is generated from
+/// fixed seeds, so each call returns the same file.
+//
+
+//------------------------------------------------------------------------------
+/// SLP sprite of frames with a round silhouette. 8 bit frames are drawn with
+/// block copies, fills, player colours, shadows and outlines like unit
+/// graphics, 32 bit frames with block copies, fills and skips.
+///
+/// @param is32bit whether the frames have 32 bit BGRA pixels instead of
+///                palette indexes
+//
+std::vector<uint8_t> makeSlp(uint32_t frameCount, uint32_t width, uint32_t height, bool is32bit);
+
+//------------------------------------------------------------------------------
+/// SMP sprite with the frame headers and row edges the library reads.
+//
+std::vector<uint8_t> makeSmp(uint32_t frameCount, uint32_t width, uint32_t height);
+
+//------------------------------------------------------------------------------
+/// SMX sprite of frames with 4plus1 compressed normal layers and shadow and
+/// outline layers.
+//
+std::vector<uint8_t> makeSmx(uint32_t frameCount, uint32_t width, uint32_t height);
+
+//------------------------------------------------------------------------------
+/// Blendomatic file, the game's has 9 modes of 31 tiles with 2353 pixels.
+//
+std::vector<uint8_t> makeBlendomatic(uint32_t modeCount, uint32_t tileCount, uint32_t pixelCount);
+
+//------------------------------------------------------------------------------
+/// DRS archive with a table of the given SLP files, with ids from 1, and a
+/// table of generated WAV files.
+//
+std::vector<uint8_t> makeDrs(genie::GameVersion gv, const std::vector<std::vector<uint8_t>> &slps,
+                             size_t wavCount);
+
+//------------------------------------------------------------------------------
+/// Version 1.21 scenario without any content. Loading it gives a scenario
+/// with all fixed size fields in place, which fillScn() adds content to.
+//
+std::vector<uint8_t> makeScn(void);
+
+//------------------------------------------------------------------------------
+/// Adds a map, units of all players and triggers to a scenario loaded from
+/// makeScn().
+///
+/// @param mapSize width and height of the map
+/// @param unitCount number of units per player
+/// @param triggerCount number of triggers
+//
+void fillScn(genie::ScnFile &scn, uint32_t mapSize, size_t unitCount, size_t triggerCount);
+
+//------------------------------------------------------------------------------
+/// @exception std::ios_base::failure thrown if the file can't be written
+//
+void writeFile(const std::string &fileName, const std::vector<uint8_t> &data);
+
+} // namespace bench
+
+#endif // GENIE_BENCH_FIXTURES_H
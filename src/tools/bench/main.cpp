@@ -0,0 +1,1099 @@
+/*
+    Benchmarks for loading and saving genie files
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Checks.h"
+#include "Fixtures.h"
+
+#include "genie/dat/DatPatch.h"
+#include "genie/resource/BlendomaticFile.h"
+#include "genie/resource/DrsFile.h"
+#include "genie/resource/PaletteExpander.h"
+#include "genie/resource/SmpFile.h"
+#include "genie/resource/SmxFile.h"
+#include "genie/util/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::pair<const char *, genie::GameVersion> games[] = {
+    { "aoe", genie::GV_AoE },
+    { "ror", genie::GV_RoR },
+    { "aok", genie::GV_AoK },
+    { "tc", genie::GV_TC },
+    { "swgb", genie::GV_SWGB },
+    { "cc", genie::GV_CC },
+};
+
+struct Options {
+    std::string suite = "all";
+    std::string datFile;
+    genie::GameVersion gameVersion = genie::GV_TC;
+    size_t civCount = 30;
+    size_t unitCount = 1000;
+    size_t iterations = 5;
+    std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+};
+
+//------------------------------------------------------------------------------
+void printUsage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [OPTION]...\n\n"
+              << "Runs the genieutils benchmarks and prints one JSON object per result.\n\n"
+              << "  --suite SUITE     benchmarks to run: dat, games, resources or all (default all),\n"
+              << "                    or check to compare the results of the fast paths instead\n"
+              << "  --dat FILE        benchmark with FILE instead of a generated DAT file\n"
+              << "  --game GAME       game of the DAT file: aoe, ror, aok, tc, swgb or cc (default tc)\n"
+              << "  --civs N          civilizations in the generated DAT file (default 30)\n"
+              << "  --units N         units per civilization in the generated DAT file (default 1000)\n"
+              << "  --iterations N    runs per measurement, the fastest one is reported (default 5)\n"
+              << "  --threads N,N...  thread counts for parallel loading and saving (default 1,2,4,8)\n";
+}
+
+//------------------------------------------------------------------------------
+bool parseGame(const std::string &name, genie::GameVersion &gv)
+{
+    for (const auto &game : games) {
+        if (name == game.first) {
+            gv = game.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool parseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            return false;
+        }
+
+        const std::string value = argv[++i];
+
+        if (arg == "--suite") {
+            if (value != "dat" && value != "games" && value != "resources" && value != "all"
+                && value != "check") {
+                return false;
+            }
+
+            options.suite = value;
+        } else if (arg == "--dat") {
+            options.datFile = value;
+        } else if (arg == "--game") {
+            if (!parseGame(value, options.gameVersion)) {
+                return false;
+            }
+        } else if (arg == "--civs") {
+            options.civCount = std::stoul(value);
+        } else if (arg == "--units") {
+            options.unitCount = std::stoul(value);
+        } else if (arg == "--iterations") {
+            options.iterations = std::max(1ul, std::stoul(value));
+        } else if (arg == "--threads") {
+            options.threadCounts.clear();
+
+            for (size_t start = 0; start < value.size();) {
+                size_t end = value.find(',', start);
+
+                if (end == std::string::npos) {
+                    end = value.size();
+                }
+
+                options.threadCounts.push_back(std::stoul(value.substr(start, end - start)));
+                start = end + 1;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/// Runs func the given number of times and returns the fastest run in seconds.
+//
+template <typename F>
+double fastestRun(size_t iterations, F &&func)
+{
+    double fastest = 0;
+
+    for (size_t i = 0; i < iterations; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (i == 0 || elapsed.count() < fastest) {
+            fastest = elapsed.count();
+        }
+    }
+
+    return fastest;
+}
+
+//------------------------------------------------------------------------------
+/// Like above, but runs setup untimed before each run of func.
+//
+template <typename S, typename F>
+double fastestRun(size_t iterations, S &&setup, F &&func)
+{
+    double fastest = 0;
+
+    for (size_t i = 0; i < iterations; i++) {
+        setup();
+
+        const double elapsed = fastestRun(1, func);
+
+        if (i == 0 || elapsed < fastest) {
+            fastest = elapsed;
+        }
+    }
+
+    return fastest;
+}
+
+//------------------------------------------------------------------------------
+/// Prints a result with the throughput in bytes and objects, labels are
+/// added as they are, like "\"game\": \"tc\", ".
+//
+void printThroughput(const char *benchmark, const std::string &labels, size_t threads,
+                     double seconds, double bytes, size_t objects)
+{
+    std::printf("{\"benchmark\": \"%s\", %s\"threads\": %zu, \"seconds\": %.6f, "
+                "\"mb_per_s\": %.2f, \"objects_per_s\": %.0f}\n",
+                benchmark, labels.c_str(), threads, seconds, bytes / (1024.0 * 1024.0) / seconds,
+                objects / seconds);
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Loads the DAT file with each thread count and compares the wall clock time
+/// to loading it with one thread.
+//
+void benchDatLoad(const Options &options, const std::string &fileName)
+{
+    const double megabytes = std::filesystem::file_size(fileName) / (1024.0 * 1024.0);
+    double singleThreaded = 0;
+
+    for (size_t threadCount : options.threadCounts) {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.setThreadCount(threadCount);
+
+        // The thread pool is created by the first load.
+        dat.load(fileName);
+
+        const double seconds = fastestRun(options.iterations, [&]() {
+            dat.load(fileName);
+        });
+
+        if (threadCount == 1 || singleThreaded == 0) {
+            singleThreaded = seconds;
+        }
+
+        std::printf("{\"benchmark\": \"dat_load\", \"threads\": %zu, \"seconds\": %.6f, "
+                    "\"mb_per_s\": %.2f, \"speedup\": %.2f}\n",
+                    threadCount, seconds, megabytes / seconds, singleThreaded / seconds);
+        std::fflush(stdout);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Loads the DAT file on one thread, once parsing while zstr inflates it and
+/// once parsing from a buffer it was inflated into at once.
+//
+void benchDatDecompress(const Options &options, const std::string &fileName)
+{
+    const double megabytes = std::filesystem::file_size(fileName) / (1024.0 * 1024.0);
+    double streamed = 0;
+
+    for (bool inMemory : { false, true }) {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.setDecompressToMemory(inMemory);
+
+        const double seconds = fastestRun(options.iterations, [&]() {
+            dat.load(fileName);
+        });
+
+        if (!inMemory) {
+            streamed = seconds;
+        }
+
+        std::printf("{\"benchmark\": \"dat_load_decompress\", \"mode\": \"%s\", \"threads\": 1, "
+                    "\"seconds\": %.6f, \"mb_per_s\": %.2f, \"speedup\": %.2f}\n",
+                    inMemory ? "inflate" : "zstr", seconds, megabytes / seconds, streamed / seconds);
+        std::fflush(stdout);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Inflates the DAT file into a raw file, once with write calls and once
+/// through a memory mapping.
+//
+void benchDatExtract(const Options &options, const std::string &fileName)
+{
+    const std::string rawFile = fileName + ".raw";
+
+    for (bool mapped : { false, true }) {
+        genie::DecompressOptions extractOptions;
+        extractOptions.mapOutput = mapped;
+
+        genie::DecompressProgress progress;
+        extractOptions.progress = [&](const genie::DecompressProgress &current) {
+            progress = current;
+        };
+
+        const double seconds = fastestRun(options.iterations, [&]() {
+            genie::DatFile().extractRaw(fileName.c_str(), rawFile.c_str(), extractOptions);
+        });
+
+        std::printf("{\"benchmark\": \"dat_extract_raw\", \"mode\": \"%s\", \"threads\": 1, "
+                    "\"seconds\": %.6f, \"mb_per_s\": %.2f}\n",
+                    mapped ? "mapped" : "write", seconds,
+                    progress.decompressedBytes / (1024.0 * 1024.0) / seconds);
+        std::fflush(stdout);
+    }
+
+    std::remove(rawFile.c_str());
+}
+
+//------------------------------------------------------------------------------
+/// Compresses and writes the loaded DAT file into memory with each thread
+/// count.
+//
+void benchDatSave(const Options &options, const std::string &fileName)
+{
+    genie::DatFile dat;
+    dat.setGameVersion(options.gameVersion);
+    dat.load(fileName);
+
+    double singleThreaded = 0;
+
+    for (size_t threadCount : options.threadCounts) {
+        dat.setThreadCount(threadCount);
+
+        size_t bytes = 0;
+
+        const double seconds = fastestRun(options.iterations, [&]() {
+            std::ostringstream out;
+            dat.writeObject(out);
+            bytes = out.tellp();
+        });
+
+        if (threadCount == 1 || singleThreaded == 0) {
+            singleThreaded = seconds;
+        }
+
+        std::printf("{\"benchmark\": \"dat_save\", \"threads\": %zu, \"seconds\": %.6f, "
+                    "\"mb_per_s\": %.2f, \"speedup\": %.2f}\n",
+                    threadCount, seconds, bytes / (1024.0 * 1024.0) / seconds, singleThreaded / seconds);
+        std::fflush(stdout);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Saves the loaded DAT file after changing one unit of one civilization,
+/// fully and incrementally, which only serializes that civilization again.
+//
+void benchDatIncrementalSave(const Options &options, const std::string &fileName)
+{
+    for (bool incremental : { false, true }) {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.setIncrementalSaving(incremental);
+        dat.load(fileName);
+
+        if (dat.Civs.empty() || dat.Civs[0].Units.empty()) {
+            return;
+        }
+
+        size_t bytes = 0;
+
+        const double seconds = fastestRun(options.iterations, [&]() {
+            dat.Civs[0].Units[0].HitPoints++;
+            dat.invalidateCiv(0);
+
+            std::ostringstream out;
+            dat.writeObject(out);
+            bytes = out.tellp();
+        });
+
+        std::printf("{\"benchmark\": \"dat_save_one_civ\", \"mode\": \"%s\", \"threads\": 1, "
+                    "\"seconds\": %.6f, \"mb_per_s\": %.2f}\n",
+                    incremental ? "incremental" : "full", seconds, bytes / (1024.0 * 1024.0) / seconds);
+        std::fflush(stdout);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Creates a patch that changes one unit of each civilization, and applies it
+/// to the loaded DAT file, compared to loading the whole patched file.
+//
+void benchDatPatch(const Options &options, const std::string &fileName)
+{
+    genie::DatFile base;
+    base.setGameVersion(options.gameVersion);
+    base.load(fileName);
+
+    genie::DatFile variant;
+    variant.setGameVersion(options.gameVersion);
+    variant.load(fileName);
+
+    for (genie::Civ &civ : variant.Civs) {
+        if (!civ.Units.empty()) {
+            civ.Units[0].HitPoints++;
+        }
+    }
+
+    const genie::DatPatch::Base patchBase(base);
+    genie::DatPatch patch;
+
+    const double createSeconds = fastestRun(options.iterations, [&]() {
+        patch.create(patchBase, variant);
+    });
+
+    double applySeconds = 0;
+
+    for (size_t i = 0; i < options.iterations; i++) {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.load(fileName);
+
+        const double seconds = fastestRun(1, [&]() {
+            patch.apply(dat);
+        });
+
+        if (i == 0 || seconds < applySeconds) {
+            applySeconds = seconds;
+        }
+    }
+
+    const double loadSeconds = fastestRun(options.iterations, [&]() {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.load(fileName);
+    });
+
+    std::printf("{\"benchmark\": \"dat_patch\", \"threads\": 1, \"entries\": %zu, "
+                "\"create_seconds\": %.6f, \"apply_seconds\": %.6f, \"load_seconds\": %.6f, "
+                "\"speedup\": %.2f}\n",
+                patch.getEntries().size(), createSeconds, applySeconds, loadSeconds,
+                loadSeconds / applySeconds);
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Loads the DAT file lazily and only reads the graphics, like tools that
+/// only need a part of the file.
+//
+void benchDatLazyLoad(const Options &options, const std::string &fileName)
+{
+    const double megabytes = std::filesystem::file_size(fileName) / (1024.0 * 1024.0);
+
+    genie::DatFile dat;
+    dat.setGameVersion(options.gameVersion);
+    dat.setLazyLoading(true);
+
+    const double seconds = fastestRun(options.iterations, [&]() {
+        dat.load(fileName);
+        dat.getGraphics();
+    });
+
+    std::printf("{\"benchmark\": \"dat_load_lazy_graphics\", \"threads\": 1, \"seconds\": %.6f, "
+                "\"mb_per_s\": %.2f}\n",
+                seconds, megabytes / seconds);
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Loads the DAT file lazily through an up to date snapshot and reads the
+/// graphics, like a process starting with a snapshot written by an earlier
+/// one.
+//
+void benchDatSnapshotLoad(const Options &options, const std::string &fileName)
+{
+    const double megabytes = std::filesystem::file_size(fileName) / (1024.0 * 1024.0);
+    const std::string snapshotFile = fileName + ".snapshot";
+
+    genie::DatFile dat;
+    dat.setGameVersion(options.gameVersion);
+    dat.setLazyLoading(true);
+
+    // Writes the snapshot.
+    dat.loadWithSnapshot(fileName, snapshotFile);
+
+    const double seconds = fastestRun(options.iterations, [&]() {
+        dat.loadWithSnapshot(fileName, snapshotFile);
+        dat.getGraphics();
+    });
+
+    std::remove(snapshotFile.c_str());
+
+    std::printf("{\"benchmark\": \"dat_load_snapshot_graphics\", \"threads\": 1, \"seconds\": %.6f, "
+                "\"mb_per_s\": %.2f}\n",
+                seconds, megabytes / seconds);
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Streams the units of the DAT file without keeping them, like an export
+/// of unit stats.
+//
+void benchDatStream(const Options &options, const std::string &fileName)
+{
+    struct UnitCounter : genie::DatFile::Visitor {
+        size_t units = 0;
+
+        void visitUnit(size_t, size_t, const genie::Unit &) override
+        {
+            units++;
+        }
+    };
+
+    const double megabytes = std::filesystem::file_size(fileName) / (1024.0 * 1024.0);
+
+    genie::DatFile dat;
+    dat.setGameVersion(options.gameVersion);
+
+    UnitCounter counter;
+
+    const double seconds = fastestRun(options.iterations, [&]() {
+        counter.units = 0;
+        dat.stream(fileName, counter);
+    });
+
+    std::printf("{\"benchmark\": \"dat_stream_units\", \"threads\": 1, \"seconds\": %.6f, "
+                "\"mb_per_s\": %.2f, \"objects_per_s\": %.0f}\n",
+                seconds, megabytes / seconds, counter.units / seconds);
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Prints one result per section of a load or save.
+//
+void printSectionStats(const char *benchmark, size_t threads, const genie::DatFile::Stats &stats)
+{
+    for (size_t i = 0; i < genie::DatFile::SECTION_COUNT; i++) {
+        const genie::DatFile::SectionStats &section = stats.sections[i];
+
+        if (section.bytes == 0) {
+            continue;
+        }
+
+        // Allocations are only known if the library counts them.
+        char allocations[32] = "null";
+
+        if (section.allocations) {
+            std::snprintf(allocations, sizeof(allocations), "%llu", (unsigned long long)*section.allocations);
+        }
+
+        std::printf("{\"benchmark\": \"%s\", \"section\": \"%s\", \"threads\": %zu, "
+                    "\"seconds\": %.6f, \"deferred_seconds\": %.6f, \"bytes\": %llu, "
+                    "\"objects\": %zu, \"allocations\": %s}\n",
+                    benchmark, genie::DatFile::getSectionName(genie::DatFile::Section(i)), threads,
+                    section.seconds, section.deferredSeconds, (unsigned long long)section.bytes,
+                    section.objects, allocations);
+    }
+
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Loads the DAT file with each thread count and saves it, and prints where
+/// the time went per section.
+//
+void benchDatSections(const Options &options, const std::string &fileName)
+{
+    for (size_t threadCount : options.threadCounts) {
+        genie::DatFile dat;
+        dat.setGameVersion(options.gameVersion);
+        dat.setThreadCount(threadCount);
+
+        // The first load creates the thread pool.
+        dat.load(fileName);
+        dat.load(fileName);
+        printSectionStats("dat_section_load", threadCount, dat.lastLoadStats());
+
+        std::ostringstream out;
+        dat.writeObject(out);
+        printSectionStats("dat_section_save", threadCount, dat.lastSaveStats());
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Loads and saves a generated DAT file of each game version.
+//
+void benchDatGames(const Options &options, const std::string &directory)
+{
+    for (const auto &game : games) {
+        const std::string fileName = directory + "/" + game.first + ".dat";
+        const std::string labels = std::string("\"game\": \"") + game.first + "\", ";
+
+        {
+            genie::DatFile dat;
+            bench::fillDat(dat, game.second, options.civCount, options.unitCount);
+            dat.saveAs(fileName.c_str());
+        }
+
+        genie::DatFile dat;
+        dat.setGameVersion(game.second);
+
+        const double loadSeconds = fastestRun(options.iterations, [&]() {
+            dat.load(fileName);
+        });
+
+        const size_t objects = bench::countDatObjects(dat);
+
+        printThroughput("dat_game_load", labels, 1, loadSeconds,
+                        std::filesystem::file_size(fileName), objects);
+
+        size_t bytes = 0;
+
+        const double saveSeconds = fastestRun(options.iterations, [&]() {
+            std::ostringstream out;
+            dat.writeObject(out);
+            bytes = out.tellp();
+        });
+
+        printThroughput("dat_game_save", labels, 1, saveSeconds, bytes, objects);
+
+        std::remove(fileName.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Loads the frame headers of an SLP file, decodes all frames and encodes
+/// them again.
+//
+void benchSlp(const Options &options, const std::string &fileName, bool is32bit)
+{
+    const size_t fileSize = std::filesystem::file_size(fileName);
+    const std::string labels = is32bit ? "\"bits\": 32, " : "\"bits\": 8, ";
+
+    std::unique_ptr<genie::SlpFile> slp;
+
+    const auto load = [&]() {
+        slp = std::make_unique<genie::SlpFile>(fileSize);
+        slp->load(fileName);
+    };
+
+    const auto decode = [&]() {
+        for (uint32_t frame = 0; frame < slp->getFrameCount(); frame++) {
+            slp->getFrame(frame);
+        }
+    };
+
+    const double loadSeconds = fastestRun(options.iterations, load);
+    const size_t frameCount = slp->getFrameCount();
+
+    printThroughput("slp_load", labels, 1, loadSeconds, fileSize, frameCount);
+
+    const double decodeSeconds = fastestRun(options.iterations, load, decode);
+
+    size_t pixelBytes = 0;
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        const genie::SlpFramePtr &slpFrame = slp->getFrame(frame);
+        pixelBytes += slpFrame->getWidth() * slpFrame->getHeight() * (is32bit ? 4 : 1);
+    }
+
+    printThroughput("slp_decode", labels, 1, decodeSeconds, pixelBytes, frameCount);
+
+    size_t bytes = 0;
+
+    const double encodeSeconds = fastestRun(options.iterations, [&]() {
+        std::ostringstream out;
+        slp->writeObject(out);
+        bytes = out.tellp();
+    });
+
+    printThroughput("slp_encode", labels, 1, encodeSeconds, bytes, frameCount);
+
+    // Straight to the RGBA pixels a renderer would upload, for player 1.
+    genie::PalFile palette;
+
+    for (int i = 0; i < 256; i++) {
+        palette.colors_.emplace_back(uint8_t(i), uint8_t(255 - i), uint8_t(i * 7));
+    }
+
+    size_t maxPixels = 0;
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        maxPixels = std::max(maxPixels, size_t(slp->frameWidth(frame)) * slp->frameHeight(frame));
+    }
+
+    std::vector<uint32_t> rgba(maxPixels);
+    size_t rgbaBytes = 0;
+
+    const double rgbaSeconds = fastestRun(options.iterations, load, [&]() {
+        rgbaBytes = 0;
+
+        for (uint32_t frame = 0; frame < frameCount; frame++) {
+            const size_t width = slp->frameWidth(frame);
+            slp->decodeFrameRgba(frame, palette, 1, rgba.data(), width);
+            rgbaBytes += width * slp->frameHeight(frame) * 4;
+        }
+    });
+
+    printThroughput("slp_decode_rgba", labels, 1, rgbaSeconds, rgbaBytes, frameCount);
+}
+
+//------------------------------------------------------------------------------
+/// Decodes all frames of a unit graphic, 8 directions of 40 frames, with
+/// SlpFile::decodeAllFrames() on a pool, or one by one for 1 thread.
+//
+void benchSlpDecodeAll(const Options &options, const std::string &fileName)
+{
+    const size_t fileSize = std::filesystem::file_size(fileName);
+
+    std::unique_ptr<genie::SlpFile> slp;
+
+    const auto load = [&]() {
+        slp = std::make_unique<genie::SlpFile>(fileSize);
+        slp->load(fileName);
+    };
+
+    load();
+    const size_t frameCount = slp->getFrameCount();
+
+    for (size_t threadCount : options.threadCounts) {
+        double seconds = 0;
+
+        if (threadCount > 1) {
+            // The calling thread decodes too.
+            genie::ThreadPool pool(threadCount - 1);
+
+            seconds = fastestRun(options.iterations, load, [&]() {
+                slp->decodeAllFrames(pool);
+            });
+        } else {
+            seconds = fastestRun(options.iterations, load, [&]() {
+                for (uint32_t frame = 0; frame < frameCount; frame++) {
+                    slp->getFrame(frame);
+                }
+            });
+        }
+
+        printThroughput("slp_decode_all", "", threadCount, seconds, fileSize, frameCount);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Expands 8-bit indexes and SMP pixels to RGBA with each palette kernel the
+/// CPU has.
+//
+void benchPaletteExpand(const Options &options)
+{
+    const size_t count = 1024 * 1024;
+
+    std::vector<uint32_t> colors(1024);
+    std::vector<uint8_t> indexes(count);
+    std::vector<genie::SmpPixel> pixels(count);
+    std::vector<uint32_t> rgba(count);
+
+    for (size_t i = 0; i < colors.size(); i++) {
+        colors[i] = uint32_t(i * 2654435761u);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        indexes[i] = uint8_t(i * 7 ^ i >> 5);
+        pixels[i] = { uint8_t(i * 13 ^ i >> 3), uint8_t(i >> 4 & 3), 0, 0 };
+    }
+
+    const genie::PaletteExpander::Kernel fastest = genie::PaletteExpander::getKernel();
+
+    for (int kernel = 0; kernel < genie::PaletteExpander::KERNEL_COUNT; kernel++) {
+        if (!genie::PaletteExpander::setKernel(genie::PaletteExpander::Kernel(kernel))) {
+            continue;
+        }
+
+        const std::string labels = std::string("\"kernel\": \"")
+            + genie::PaletteExpander::getKernelName(genie::PaletteExpander::Kernel(kernel)) + "\", ";
+
+        const double bytesSeconds = fastestRun(options.iterations, [&]() {
+            genie::PaletteExpander::expand(indexes.data(), count, colors.data(), rgba.data(), 16);
+        });
+
+        printThroughput("palette_expand_8bit", labels, 1, bytesSeconds, count * 4, count);
+
+        const double smpSeconds = fastestRun(options.iterations, [&]() {
+            genie::PaletteExpander::expand(pixels.data(), count, colors.data(), rgba.data());
+        });
+
+        printThroughput("palette_expand_smp", labels, 1, smpSeconds, count * 4, count);
+    }
+
+    genie::PaletteExpander::setKernel(fastest);
+}
+
+//------------------------------------------------------------------------------
+/// Loads an SMP file, which only reads the frame headers and row edges.
+//
+void benchSmp(const Options &options, const std::string &fileName, size_t frameCount)
+{
+#ifndef NDEBUG
+    // SmpFrame asserts that reading it isn't implemented.
+    std::printf("{\"benchmark\": \"smp_load\", \"skipped\": \"debug build\"}\n");
+    std::fflush(stdout);
+#else
+    const double seconds = fastestRun(options.iterations, [&]() {
+        genie::SmpFile smp;
+        smp.load(fileName);
+    });
+
+    printThroughput("smp_load", "", 1, seconds, std::filesystem::file_size(fileName), frameCount);
+#endif
+}
+
+//------------------------------------------------------------------------------
+/// Loads an SMX file, which decodes the normal layer of all frames.
+//
+void benchSmx(const Options &options, const std::string &fileName, size_t frameCount)
+{
+    const double seconds = fastestRun(options.iterations, [&]() {
+        genie::SmxFile smx;
+        smx.load(fileName);
+    });
+
+    printThroughput("smx_load_decode", "", 1, seconds, std::filesystem::file_size(fileName), frameCount);
+}
+
+//------------------------------------------------------------------------------
+/// Loads and saves a blendomatic file.
+//
+void benchBlendomatic(const Options &options, const std::string &fileName, size_t modeCount)
+{
+    genie::BlendomaticFile blendomatic;
+
+    const double loadSeconds = fastestRun(options.iterations, [&]() {
+        blendomatic.load(fileName);
+    });
+
+    printThroughput("blendomatic_load", "", 1, loadSeconds, std::filesystem::file_size(fileName), modeCount);
+
+    size_t bytes = 0;
+
+    const double saveSeconds = fastestRun(options.iterations, [&]() {
+        std::ostringstream out;
+        blendomatic.writeObject(out);
+        bytes = out.tellp();
+    });
+
+    printThroughput("blendomatic_save", "", 1, saveSeconds, bytes, modeCount);
+}
+
+//------------------------------------------------------------------------------
+/// Prints one result per resource type that was read.
+//
+void printIoStats(const char *benchmark, const genie::IoStats::Snapshot &snapshot)
+{
+    for (size_t i = 0; i < genie::IoStats::IO_RESOURCE_COUNT; i++) {
+        const genie::IoStats::Counters &counters = snapshot[i];
+
+        if (counters.readCalls == 0 && counters.seeks == 0) {
+            continue;
+        }
+
+        std::printf("{\"benchmark\": \"%s\", \"resource\": \"%s\", \"read_calls\": %llu, "
+                    "\"bytes_read\": %llu, \"seeks\": %llu, \"seek_distance\": %llu}\n",
+                    benchmark, genie::IoStats::getResourceName(genie::IoStats::Resource(i)),
+                    (unsigned long long)counters.readCalls, (unsigned long long)counters.bytesRead,
+                    (unsigned long long)counters.seeks, (unsigned long long)counters.seekDistance);
+    }
+
+    std::fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+/// Loads the tables of a DRS file from makeDrs(), and reads all files in it.
+/// Also prints the reads and seeks of decoding all SLP frames.
+//
+void benchDrs(const Options &options, const std::string &fileName, uint32_t slpCount, uint32_t wavCount)
+{
+    const size_t fileSize = std::filesystem::file_size(fileName);
+
+    const double loadSeconds = fastestRun(options.iterations, [&]() {
+        genie::DrsFile drs;
+        drs.load(fileName);
+    });
+
+    printThroughput("drs_load", "", 1, loadSeconds, fileSize, slpCount + wavCount);
+
+    const double readSeconds = fastestRun(options.iterations, [&]() {
+        genie::DrsFile drs;
+        drs.load(fileName);
+
+        // The ids are numbered from 1, SLP files first.
+        for (uint32_t id = 1; id <= slpCount; id++) {
+            drs.getSlpFile(id);
+        }
+
+        for (uint32_t id = slpCount + 1; id <= slpCount + wavCount; id++) {
+            drs.getWavPtr(id);
+        }
+    });
+
+    printThroughput("drs_read", "", 1, readSeconds, fileSize, slpCount + wavCount);
+
+    // The same in place, without copying the SLP files and sounds.
+    const double mappedSeconds = fastestRun(options.iterations, [&]() {
+        genie::DrsFile drs;
+        drs.setLoadMode(genie::IFile::LOAD_MAPPED);
+        drs.load(fileName);
+
+        for (uint32_t id = 1; id <= slpCount; id++) {
+            drs.getSlpFile(id);
+        }
+
+        for (uint32_t id = slpCount + 1; id <= slpCount + wavCount; id++) {
+            drs.getWavView(id);
+        }
+    });
+
+    printThroughput("drs_read_mapped", "", 1, mappedSeconds, fileSize, slpCount + wavCount);
+
+    // All frames decoded from one archive by several threads.
+    for (size_t threadCount : options.threadCounts) {
+        const double decodeSeconds = fastestRun(options.iterations, [&]() {
+            genie::DrsFile drs;
+            drs.load(fileName);
+
+            std::vector<std::thread> threads;
+
+            for (size_t thread = 0; thread < threadCount; thread++) {
+                threads.emplace_back([&, thread]() {
+                    for (uint32_t id = 1 + thread; id <= slpCount; id += threadCount) {
+                        const genie::SlpFilePtr slp = drs.getSlpFile(id);
+
+                        for (uint32_t frame = 0; frame < slp->getFrameCount(); frame++) {
+                            slp->getFrame(frame);
+                        }
+                    }
+                });
+            }
+
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+        });
+
+        printThroughput("drs_decode_parallel", "", threadCount, decodeSeconds, fileSize, slpCount);
+    }
+
+    // Once more with counting, which isn't timed as it slows reading down.
+    genie::IoStats::reset();
+    genie::IoStats::setEnabled(true);
+
+    {
+        genie::DrsFile drs;
+        drs.load(fileName);
+
+        for (uint32_t id = 1; id <= slpCount; id++) {
+            const genie::SlpFilePtr slp = drs.getSlpFile(id);
+
+            for (uint32_t frame = 0; frame < slp->getFrameCount(); frame++) {
+                slp->getFrame(frame);
+            }
+        }
+
+        for (uint32_t id = slpCount + 1; id <= slpCount + wavCount; id++) {
+            drs.getWavPtr(id);
+        }
+    }
+
+    genie::IoStats::setEnabled(false);
+    printIoStats("drs_read_io", genie::IoStats::snapshot());
+}
+
+//------------------------------------------------------------------------------
+/// Loads a scenario, and saves it with each thread count.
+//
+void benchScn(const Options &options, const std::string &fileName)
+{
+    genie::ScnFile scn;
+
+    const double loadSeconds = fastestRun(options.iterations, [&]() {
+        scn.load(fileName);
+    });
+
+    size_t unitCount = 0;
+
+    for (const genie::ScnPlayerUnits &player : scn.playerUnits) {
+        unitCount += player.units.size();
+    }
+
+    const size_t objects = unitCount + scn.triggers.size();
+
+    printThroughput("scn_load", "", 1, loadSeconds, std::filesystem::file_size(fileName), objects);
+
+    for (size_t threadCount : options.threadCounts) {
+        scn.setThreadCount(threadCount);
+
+        size_t bytes = 0;
+
+        const double saveSeconds = fastestRun(options.iterations, [&]() {
+            std::ostringstream out;
+            scn.writeObject(out);
+            bytes = out.tellp();
+        });
+
+        printThroughput("scn_save", "", threadCount, saveSeconds, bytes, objects);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Generates the resource and scenario fixtures into directory and runs
+/// their benchmarks.
+//
+void benchResources(const Options &options, const std::string &directory)
+{
+    const uint32_t slpFrames = 50;
+    const uint32_t spriteFrames = 30;
+    const uint32_t blendModes = 9;
+    const uint32_t drsSlps = 200;
+    const uint32_t drsWavs = 100;
+
+    const std::string slp8File = directory + "/8bit.slp";
+    const std::string slp32File = directory + "/32bit.slp";
+    const std::string unitSlpFile = directory + "/unit.slp";
+    const std::string smpFile = directory + "/sprite.smp";
+    const std::string smxFile = directory + "/sprite.smx";
+    const std::string blendomaticFile = directory + "/blendomatic.dat";
+    const std::string drsFile = directory + "/graphics.drs";
+    const std::string scnFile = directory + "/scenario.scx";
+
+    bench::writeFile(slp8File, bench::makeSlp(slpFrames, 128, 128, false));
+    bench::writeFile(slp32File, bench::makeSlp(slpFrames, 128, 128, true));
+    bench::writeFile(unitSlpFile, bench::makeSlp(8 * 40, 96, 96, false));
+    bench::writeFile(smpFile, bench::makeSmp(spriteFrames, 256, 256));
+    bench::writeFile(smxFile, bench::makeSmx(spriteFrames, 256, 256));
+    bench::writeFile(blendomaticFile, bench::makeBlendomatic(blendModes, 31, 2353));
+
+    std::vector<std::vector<uint8_t>> slps;
+
+    for (uint32_t i = 0; i < drsSlps; i++) {
+        slps.push_back(bench::makeSlp(1 + i % 10, 32 + i % 64, 32 + i % 48, false));
+    }
+
+    bench::writeFile(drsFile, bench::makeDrs(options.gameVersion, slps, drsWavs));
+
+    {
+        bench::writeFile(scnFile, bench::makeScn());
+
+        genie::ScnFile scn;
+        scn.load(scnFile);
+        bench::fillScn(scn, 200, 1000, 500);
+        scn.saveAs(scnFile.c_str());
+    }
+
+    benchSlp(options, slp8File, false);
+    benchSlp(options, slp32File, true);
+    benchSlpDecodeAll(options, unitSlpFile);
+    benchPaletteExpand(options);
+    benchSmp(options, smpFile, spriteFrames);
+    benchSmx(options, smxFile, spriteFrames);
+    benchBlendomatic(options, blendomaticFile, blendModes);
+    benchDrs(options, drsFile, drsSlps, drsWavs);
+    benchScn(options, scnFile);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    Options options;
+
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Results are written with printf, debug output of the library would
+    // mix with them.
+    std::cout.setstate(std::ios::badbit);
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "genieutils_bench";
+    std::filesystem::create_directories(directory);
+
+    std::string datFile = options.datFile;
+    size_t failedChecks = 0;
+
+    try {
+        if (options.suite == "check") {
+            for (const auto &game : games) {
+                failedChecks += bench::checkDat(directory.string(), game.first, game.second,
+                                                options.civCount, options.unitCount);
+            }
+
+            failedChecks += bench::checkPaletteExpander();
+        }
+
+        if (options.suite == "dat" || options.suite == "all") {
+            if (datFile.empty()) {
+                datFile = (directory / "bench.dat").string();
+
+                genie::DatFile dat;
+                bench::fillDat(dat, options.gameVersion, options.civCount, options.unitCount);
+                dat.saveAs(datFile.c_str());
+            }
+
+            benchDatLoad(options, datFile);
+            benchDatDecompress(options, datFile);
+            benchDatExtract(options, datFile);
+            benchDatSave(options, datFile);
+            benchDatIncrementalSave(options, datFile);
+            benchDatPatch(options, datFile);
+            benchDatLazyLoad(options, datFile);
+            benchDatSnapshotLoad(options, datFile);
+            benchDatStream(options, datFile);
+            benchDatSections(options, datFile);
+        }
+
+        if (options.suite == "games" || options.suite == "all") {
+            benchDatGames(options, directory.string());
+        }
+
+        if (options.suite == "resources" || options.suite == "all") {
+            benchResources(options, directory.string());
+        }
+    } catch (const std::exception &error) {
+        std::cerr << "Benchmark failed: " << error.what() << std::endl;
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+
+    std::filesystem::remove_all(directory);
+
+    return failedChecks == 0 ? 0 : 1;
+}
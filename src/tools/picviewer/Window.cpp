@@ -254,20 +254,9 @@ QPixmap Window::createPixmap(const genie::SmxFrame &frame)
 //    }
 
     m_smxFrame = frame;
-    QImage image(frame.width(), frame.height(), QImage::Format_ARGB32_Premultiplied);
-    for (int x=0; x<frame.width(); x++) {
-        for (int y=0; y<frame.height(); y++) {
-            if (!frame.isVisible(x, y)) {
-                continue;
-            }
-            const size_t palIndex = frame.paletteIndex(x, y);
-//            qDebug() << palIndex << frame.pixel(x, y).index << frame.pixel(x, y).section << frame.paletteIndex(x, y);
-            assert(palIndex < m_palette.colors_.size());
-            const genie::Color &color = m_palette.colors_[palIndex];
-//            qDebug() << color.a << color.g << color.b << color.a;
-            image.setPixel(x, y, qRgba(color.r, color.g, color.b, color.a));
-        }
-    }
+    // Same byte order as genie::Color::toUint32()
+    QImage image(frame.width(), frame.height(), QImage::Format_RGBA8888);
+    frame.decodeRgba(m_palette, reinterpret_cast<uint32_t*>(image.bits()), image.bytesPerLine() / 4);
 
     return QPixmap::fromImage(image);
 }
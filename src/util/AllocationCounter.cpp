@@ -0,0 +1,142 @@
+/*
+    Counts heap allocations per thread
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/util/AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace genie {
+
+namespace {
+
+/// Counted per thread, so counting doesn't need any synchronization.
+thread_local uint64_t allocationCount = 0;
+
+} // namespace
+
+//------------------------------------------------------------------------------
+uint64_t getAllocationCount(void)
+{
+    return allocationCount;
+}
+
+//------------------------------------------------------------------------------
+bool isCountingAllocations(void)
+{
+#ifdef GUTILS_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace genie
+
+#ifdef GUTILS_COUNT_ALLOCATIONS
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// Allocates like the default operator new and counts the allocation.
+//
+void *countedNew(std::size_t size)
+{
+    ++genie::allocationCount;
+
+    for (;;) {
+        if (void *memory = std::malloc(size ? size : 1)) {
+            return memory;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+
+        handler();
+    }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+/// All forms of operator new and delete, except the aligned ones, are
+/// replaced together, so none of them depends on how the standard library
+/// forwards between its own.
+//
+void *operator new(std::size_t size)
+{
+    return countedNew(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedNew(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+
+#endif // GUTILS_COUNT_ALLOCATIONS
@@ -0,0 +1,109 @@
+/*
+    Fixed set of worker threads running queued tasks
+    Copyright (C) 2026  genieutils contributors
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "genie/util/ThreadPool.h"
+
+#include <algorithm>
+
+namespace genie {
+
+//------------------------------------------------------------------------------
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    workers_.reserve(threadCount);
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers_.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+//------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    wakeUp_.notify_all();
+
+    for (std::thread &worker : workers_) {
+        worker.join();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool ThreadPool::runPendingTask(void)
+{
+    std::function<void()> task;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (tasks_.empty()) {
+            return false;
+        }
+
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+    }
+
+    task();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void ThreadPool::push(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+
+    wakeUp_.notify_one();
+}
+
+//------------------------------------------------------------------------------
+void ThreadPool::work(void)
+{
+    for (;;) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeUp_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+            // Queued tasks are still run when stopping, their futures are
+            // likely waited for.
+            if (tasks_.empty()) {
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
+} // namespace genie